@@ -476,6 +476,57 @@ v_ast_make_list_generic_list_impl(ast_generic_list_t *ret, v_quark_t tag,
 AST_DEFINE_LIST_AGSGI_IMPL(ast_generic_list_data_t, generic_list)
 
 
+//---------------------------------------------------------------------
+//- List builders ...
+//---------------------------------------------------------------------
+VOIDC_DEFINE_INITIALIZE_IMPL(ast_list_builder_t, v_ast_initialize_list_builder_impl)
+VOIDC_DEFINE_TERMINATE_IMPL(ast_list_builder_t, v_ast_terminate_list_builder_impl)
+VOIDC_DEFINE_COPY_IMPL(ast_list_builder_t, v_ast_copy_list_builder_impl)
+VOIDC_DEFINE_MOVE_IMPL(ast_list_builder_t, v_ast_move_list_builder_impl)
+VOIDC_DEFINE_STD_ANY_GET_POINTER_IMPL(ast_list_builder_t, v_ast_std_any_get_pointer_list_builder_impl)
+VOIDC_DEFINE_STD_ANY_SET_POINTER_IMPL(ast_list_builder_t, v_ast_std_any_set_pointer_list_builder_impl)
+
+bool
+v_ast_empty_list_builder_impl(const ast_list_builder_t *ptr)
+{
+    return  ptr->size == 0;
+}
+
+//---------------------------------------------------------------------
+void
+v_ast_list_builder_append(ast_list_builder_t *ret, const ast_list_builder_t *builder,
+                          const ast_base_t *items, size_t count)
+{
+    if (builder)  *ret = builder->append(items, count);
+    else          *ret = ast_list_builder_t().append(items, count);
+}
+
+size_t
+v_ast_list_builder_get_size(const ast_list_builder_t *builder)
+{
+    return  builder->size;
+}
+
+//---------------------------------------------------------------------
+void
+v_ast_list_builder_freeze_stmt_list(ast_stmt_list_t *ret, const ast_list_builder_t *builder)
+{
+    *ret = builder->freeze<ast_stmt_list_data_t>();
+}
+
+void
+v_ast_list_builder_freeze_expr_list(ast_expr_list_t *ret, const ast_list_builder_t *builder)
+{
+    *ret = builder->freeze<ast_expr_list_data_t>();
+}
+
+void
+v_ast_list_builder_freeze_generic_list(ast_generic_list_t *ret, v_quark_t tag, const ast_list_builder_t *builder)
+{
+    *ret = builder->freeze<ast_generic_list_data_t>(tag);
+}
+
+
 //---------------------------------------------------------------------
 VOIDC_DLLEXPORT_END
 
@@ -517,8 +568,18 @@ v_ast_static_initialize(void)
 
 #undef DEF
 
+    {   static_assert((sizeof(ast_list_builder_t) % sizeof(intptr_t)) == 0);
+
+        v_type_t *builder_content_type = vctx.make_array_type(vctx.intptr_t_type, sizeof(ast_list_builder_t)/sizeof(intptr_t));
+
+        auto list_builder_q = v_quark_from_string("v_ast_list_builder_t");
+        auto list_builder_type = vctx.make_struct_type(list_builder_q);
+        list_builder_type->set_body(&builder_content_type, 1, false);
+        vctx.initialize_type(list_builder_q, list_builder_type);
+    }
+
 #define DEF(name) \
-    v_ast_##name##_tag = v_quark_from_string(#name);
+    v_ast_##name##_tag = v_static_quark_##name;
 
     DEFINE_AST_TAGS(DEF)
 
@@ -12,6 +12,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <any>
+#include <vector>
 #include <unordered_map>
 
 #include <immer/vector.hpp>
@@ -86,11 +87,16 @@ template<typename T>
 struct ast_base_list_data_t : ast_base_data_t
 {
     using item_t = T;
+    using data_t = immer::vector<std::shared_ptr<const T>>;
 
-    const immer::vector<std::shared_ptr<const T>> data;
+    const data_t data;
 
     ast_base_list_data_t() : data{} {}
 
+    explicit ast_base_list_data_t(data_t &&_data)
+      : data(std::move(_data))
+    {}
+
     ast_base_list_data_t(const std::shared_ptr<const T> *items, size_t count)
       : data(items, items+count)
     {}
@@ -106,7 +112,7 @@ struct ast_base_list_data_t : ast_base_data_t
     {}
 
 private:
-    immer::vector<std::shared_ptr<const T>>
+    data_t
     do_append(const std::shared_ptr<const T> *items, size_t count) const
     {
         auto t = data.transient();
@@ -131,6 +137,10 @@ struct ast_list_data_t : ast_base_list_data_t<T>
       : base_t(items, count)
     {}
 
+    explicit ast_list_data_t(typename base_t::data_t &&data)
+      : base_t(std::move(data))
+    {}
+
     ast_list_data_t(const std::shared_ptr<const ast_list_data_t<T, Tag>> &list,
                     const std::shared_ptr<const T> &item)
       : base_t(list, item)
@@ -346,6 +356,11 @@ struct ast_generic_list_data_t : ast_base_list_data_t<ast_base_data_t>
         visitor_method_tag(tag)
     {}
 
+    ast_generic_list_data_t(v_quark_t tag, base_t::data_t &&data)
+      : base_t(std::move(data)),
+        visitor_method_tag(tag)
+    {}
+
     ast_generic_list_data_t(const std::shared_ptr<const ast_generic_list_data_t> &list,
                             const ast_base_t &item)
       : base_t(list, item),
@@ -371,6 +386,62 @@ private:
 typedef std::shared_ptr<const ast_generic_list_data_t> ast_generic_list_t;
 
 
+//---------------------------------------------------------------------
+//- List builder: a "slice" of a shared growable buffer of ast_base_t
+//---------------------------------------------------------------------
+//- Appending to the slice which ends the buffer is done in place, so
+//- a chain of left-recursive actions costs O(N) instead of a new list
+//- per item. Older builders stay valid (they just see fewer items),
+//- appending to them copies their part of the buffer first.
+//- Then freeze() makes a list (any kind) in one pass.
+//- Not thread-safe: builders live inside one parse...
+//---------------------------------------------------------------------
+struct ast_list_builder_t
+{
+    std::shared_ptr<std::vector<ast_base_t>> buffer;
+
+    size_t size = 0;
+
+public:
+    ast_list_builder_t append(const ast_base_t *items, size_t count) const
+    {
+        ast_list_builder_t ret = *this;
+
+        if (!buffer  ||  buffer->size() != size)
+        {
+            auto nbuf = std::make_shared<std::vector<ast_base_t>>();
+
+            nbuf->reserve(size + count);
+
+            if (buffer) nbuf->assign(buffer->begin(), buffer->begin()+size);
+
+            ret.buffer = nbuf;
+        }
+
+        ret.buffer->insert(ret.buffer->end(), items, items+count);
+
+        ret.size += count;
+
+        return ret;
+    }
+
+    template<typename L, typename... A>
+    std::shared_ptr<const L> freeze(A&&... args) const
+    {
+        using item_t = typename L::item_t;
+
+        immer::vector_transient<std::shared_ptr<const item_t>> t;
+
+        for (size_t i=0; i<size; ++i)
+        {
+            t.push_back(std::static_pointer_cast<const item_t>((*buffer)[i]));
+        }
+
+        return  std::make_shared<const L>(std::forward<A>(args)..., t.persistent());
+    }
+};
+
+
 //---------------------------------------------------------------------
 //- ...
 //---------------------------------------------------------------------
@@ -0,0 +1,727 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_ast_serial.h"
+
+#include <typeindex>
+#include <string_view>
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+namespace
+{
+
+constexpr uint8_t ast_serial_version = 2;
+
+//---------------------------------------------------------------------
+enum node_kind_t : uint8_t
+{
+    nk_null,
+
+    nk_unit,
+    nk_stmt_list,
+    nk_expr_list,
+    nk_stmt,
+    nk_expr_call,
+    nk_expr_identifier,
+    nk_expr_integer,
+    nk_expr_string,
+    nk_expr_char,
+
+    nk_generic,
+    nk_unit_generic,
+    nk_stmt_generic,
+    nk_expr_generic,
+    nk_generic_list,
+};
+
+static const
+std::unordered_map<std::type_index, node_kind_t>
+node_kinds
+{
+    {typeid(ast_unit_data_t),            nk_unit},
+    {typeid(ast_stmt_list_data_t),       nk_stmt_list},
+    {typeid(ast_expr_list_data_t),       nk_expr_list},
+    {typeid(ast_stmt_data_t),            nk_stmt},
+    {typeid(ast_expr_call_data_t),       nk_expr_call},
+    {typeid(ast_expr_identifier_data_t), nk_expr_identifier},
+    {typeid(ast_expr_integer_data_t),    nk_expr_integer},
+    {typeid(ast_expr_string_data_t),     nk_expr_string},
+    {typeid(ast_expr_char_data_t),       nk_expr_char},
+
+    {typeid(ast_generic_data_t),         nk_generic},
+    {typeid(ast_unit_generic_data_t),    nk_unit_generic},
+    {typeid(ast_stmt_generic_data_t),    nk_stmt_generic},
+    {typeid(ast_expr_generic_data_t),    nk_expr_generic},
+    {typeid(ast_generic_list_data_t),    nk_generic_list},
+};
+
+
+//---------------------------------------------------------------------
+//- No v_quark_t here: it is just uint32_t, so any uint32_t property would
+//- be taken for a quark (and dynamic quarks differ from run to run)...
+
+#define AST_SERIAL_VALUE_TYPES(DEF) \
+    DEF(size_t,          size_t) \
+    DEF(intptr_t,        intptr_t) \
+    DEF(int,             int) \
+    DEF(bool,            bool) \
+    DEF(char32_t,        char32_t) \
+    DEF(string,          std::string) \
+    DEF(ast_base,        ast_base_t) \
+    DEF(ast_unit,        ast_unit_t) \
+    DEF(ast_stmt,        ast_stmt_t) \
+    DEF(ast_stmt_list,   ast_stmt_list_t) \
+    DEF(ast_expr,        ast_expr_t) \
+    DEF(ast_expr_list,   ast_expr_list_t) \
+    DEF(ast_generic_list, ast_generic_list_t)
+
+enum value_kind_t : uint8_t
+{
+#define DEF(name, type)  vk_##name,
+
+    AST_SERIAL_VALUE_TYPES(DEF)
+
+#undef DEF
+};
+
+static const
+std::unordered_map<std::type_index, value_kind_t>
+value_kinds
+{
+#define DEF(name, type)  {typeid(type), vk_##name},
+
+    AST_SERIAL_VALUE_TYPES(DEF)
+
+#undef DEF
+};
+
+
+//---------------------------------------------------------------------
+struct generic_serializer_t
+{
+    const ast_generic_vtable_t *vtable;
+    size_t                      size;
+
+    ast_generic_save_fun_t save;
+    ast_generic_load_fun_t load;
+
+    void *aux;
+};
+
+static std::unordered_map<const ast_generic_vtable_t *, generic_serializer_t> generic_savers;
+static std::unordered_map<v_quark_t, generic_serializer_t>                    generic_loaders;
+
+
+//---------------------------------------------------------------------
+struct bad_format_t {};         //- Internal: "can't do it"...
+
+
+//---------------------------------------------------------------------
+//- Writer
+//---------------------------------------------------------------------
+struct writer_t
+{
+    explicit writer_t(std::string &_out)
+      : out(_out)
+    {}
+
+    std::string &out;
+
+    std::unordered_map<v_quark_t, size_t> quarks;
+
+public:
+    void put_byte(uint8_t b)  { out.push_back(char(b)); }
+
+    void put_uint(uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            put_byte(uint8_t(v) | 0x80);
+
+            v >>= 7;
+        }
+
+        put_byte(uint8_t(v));
+    }
+
+    void put_int(int64_t v)     //- "Zigzag"
+    {
+        put_uint((uint64_t(v) << 1) ^ uint64_t(v >> 63));
+    }
+
+    void put_bytes(const char *data, size_t size)
+    {
+        put_uint(size);
+
+        out.append(data, size);
+    }
+
+    //- 0 - null, index+1 - known, quarks.size()+1 - new (string follows)
+
+    void put_quark(v_quark_t q)
+    {
+        if (!q)
+        {
+            put_uint(0);
+
+            return;
+        }
+
+        if (auto it = quarks.find(q);  it != quarks.end())
+        {
+            put_uint(it->second);
+
+            return;
+        }
+
+        if (q > v_quark_last())  throw bad_format_t();      //- Just uint32_t, not a quark...
+
+        size_t len = 0;
+
+        auto *str = v_quark_to_string_view(q, &len);
+
+        if (!str)  throw bad_format_t();
+
+        size_t idx = quarks.size() + 1;
+
+        quarks[q] = idx;
+
+        put_uint(idx);
+
+        put_bytes(str, len);
+    }
+
+public:
+    template<typename T>
+    void put_list(const T &list)
+    {
+        put_uint(list.data.size());
+
+        for (auto &it : list.data)  put_node(it);
+    }
+
+    template<typename T>
+    void put_generic(const T &node)
+    {
+        auto it = generic_savers.find(node.vtable);
+
+        if (it == generic_savers.end())  throw bad_format_t();
+
+        auto &gs = it->second;
+
+        put_quark(node.vtable->tag);
+
+        std::string blob;
+
+        if (!gs.save(gs.aux, &blob, node.object))  throw bad_format_t();
+
+        put_bytes(blob.data(), blob.size());
+    }
+
+    void put_node(const ast_base_t &node);
+
+    void put_value(const std::any &value);
+};
+
+
+//---------------------------------------------------------------------
+void
+writer_t::put_node(const ast_base_t &node)
+{
+    if (!node)
+    {
+        put_byte(nk_null);
+
+        return;
+    }
+
+    auto &data = *node;
+
+    auto it = node_kinds.find(typeid(data));
+
+    if (it == node_kinds.end())  throw bad_format_t();
+
+    auto kind = it->second;
+
+    put_byte(kind);
+
+    switch(kind)
+    {
+    case nk_unit:
+        {   auto &n = static_cast<const ast_unit_data_t &>(data);
+
+            put_node(n.stmt_list);
+            put_int(n.line);
+            put_int(n.column);
+        }
+        break;
+
+    case nk_stmt_list:
+        put_list(static_cast<const ast_stmt_list_data_t &>(data));
+        break;
+
+    case nk_expr_list:
+        put_list(static_cast<const ast_expr_list_data_t &>(data));
+        break;
+
+    case nk_stmt:
+        {   auto &n = static_cast<const ast_stmt_data_t &>(data);
+
+            put_quark(n.name);
+            put_node(n.expr);
+        }
+        break;
+
+    case nk_expr_call:
+        {   auto &n = static_cast<const ast_expr_call_data_t &>(data);
+
+            put_node(n.fun_expr);
+            put_node(n.arg_list);
+        }
+        break;
+
+    case nk_expr_identifier:
+        put_quark(static_cast<const ast_expr_identifier_data_t &>(data).name);
+        break;
+
+    case nk_expr_integer:
+        put_int(static_cast<const ast_expr_integer_data_t &>(data).number);
+        break;
+
+    case nk_expr_string:
+        {   auto &s = static_cast<const ast_expr_string_data_t &>(data).string;
+
+            put_bytes(s.data(), s.size());
+        }
+        break;
+
+    case nk_expr_char:
+        put_uint(static_cast<const ast_expr_char_data_t &>(data).char_);
+        break;
+
+    case nk_generic:
+        put_generic(static_cast<const ast_generic_data_t &>(data));
+        break;
+
+    case nk_unit_generic:
+        put_generic(static_cast<const ast_unit_generic_data_t &>(data));
+        break;
+
+    case nk_stmt_generic:
+        put_generic(static_cast<const ast_stmt_generic_data_t &>(data));
+        break;
+
+    case nk_expr_generic:
+        put_generic(static_cast<const ast_expr_generic_data_t &>(data));
+        break;
+
+    case nk_generic_list:
+        {   auto &n = static_cast<const ast_generic_list_data_t &>(data);
+
+            put_quark(n.tag());
+            put_list(n);
+        }
+        break;
+
+    default:
+        throw bad_format_t();
+    }
+
+    put_uint(data.properties.size());
+
+    for (auto &[q, v] : data.properties)
+    {
+        put_quark(q);
+        put_value(v);
+    }
+}
+
+//---------------------------------------------------------------------
+void
+writer_t::put_value(const std::any &value)
+{
+    auto it = value_kinds.find(value.type());
+
+    if (it == value_kinds.end())  throw bad_format_t();
+
+    auto kind = it->second;
+
+    put_byte(kind);
+
+    switch(kind)
+    {
+    case vk_size_t:     put_uint(std::any_cast<size_t>(value));       break;
+    case vk_intptr_t:   put_int(std::any_cast<intptr_t>(value));      break;
+    case vk_int:        put_int(std::any_cast<int>(value));           break;
+    case vk_bool:       put_byte(std::any_cast<bool>(value));         break;
+    case vk_char32_t:   put_uint(std::any_cast<char32_t>(value));     break;
+
+    case vk_string:
+        {   auto &s = std::any_cast<const std::string &>(value);
+
+            put_bytes(s.data(), s.size());
+        }
+        break;
+
+#define DEF(name) \
+    case vk_##name: \
+        put_node(std::any_cast<const name##_t &>(value)); \
+        break;
+
+    DEF(ast_base)
+    DEF(ast_unit)
+    DEF(ast_stmt)
+    DEF(ast_stmt_list)
+    DEF(ast_expr)
+    DEF(ast_expr_list)
+    DEF(ast_generic_list)
+
+#undef DEF
+    }
+}
+
+
+//---------------------------------------------------------------------
+//- Reader
+//---------------------------------------------------------------------
+struct reader_t
+{
+    reader_t(const char *data, size_t size)
+      : cur(data),
+        end(data + size)
+    {}
+
+    const char *cur;
+    const char * const end;
+
+    std::vector<v_quark_t> quarks;
+
+public:
+    uint8_t get_byte(void)
+    {
+        if (cur == end)  throw bad_format_t();
+
+        return uint8_t(*cur++);
+    }
+
+    uint64_t get_uint(void)
+    {
+        uint64_t v = 0;
+
+        for (int shift=0; ; shift += 7)
+        {
+            if (shift > 63)  throw bad_format_t();
+
+            auto b = get_byte();
+
+            v |= uint64_t(b & 0x7F) << shift;
+
+            if (!(b & 0x80))  return v;
+        }
+    }
+
+    int64_t get_int(void)
+    {
+        auto u = get_uint();
+
+        return  int64_t(u >> 1) ^ -int64_t(u & 1);
+    }
+
+    std::string_view get_bytes(void)
+    {
+        auto size = get_uint();
+
+        if (size > size_t(end - cur))  throw bad_format_t();
+
+        std::string_view ret(cur, size);
+
+        cur += size;
+
+        return ret;
+    }
+
+    v_quark_t get_quark(void)
+    {
+        auto idx = get_uint();
+
+        if (idx == 0)  return 0;
+
+        if (idx <= quarks.size())  return quarks[idx-1];
+
+        if (idx != quarks.size()+1)  throw bad_format_t();
+
+        auto str = get_bytes();
+
+        auto q = v_quark_from_string_n(str.data(), str.size());
+
+        quarks.push_back(q);
+
+        return q;
+    }
+
+public:
+    ast_base_t get_node(void);
+
+    template<typename T>
+    std::shared_ptr<const T> get_node_as(void)
+    {
+        auto node = get_node();
+
+        if (!node)  return nullptr;
+
+        auto ret = std::dynamic_pointer_cast<const T>(node);
+
+        if (!ret)  throw bad_format_t();
+
+        return ret;
+    }
+
+    template<typename T>
+    typename T::data_t get_list(void)
+    {
+        using item_t = typename T::item_t;
+
+        auto count = get_uint();
+
+        immer::vector_transient<std::shared_ptr<const item_t>> t;
+
+        for (uint64_t i=0; i<count; ++i)  t.push_back(get_node_as<item_t>());
+
+        return t.persistent();
+    }
+
+    template<typename T>
+    ast_base_t get_generic(void)
+    {
+        auto tag = get_quark();
+
+        auto it = generic_loaders.find(tag);
+
+        if (it == generic_loaders.end())  throw bad_format_t();
+
+        auto &gs = it->second;
+
+        auto blob = get_bytes();
+
+        auto ret = std::make_shared<const T>(gs.vtable, gs.size);
+
+        if (!gs.load(gs.aux, ret->object, blob.data(), blob.size()))  throw bad_format_t();
+
+        return ret;
+    }
+
+    std::any get_value(void);
+};
+
+
+//---------------------------------------------------------------------
+ast_base_t
+reader_t::get_node(void)
+{
+    auto kind = get_byte();
+
+    ast_base_t ret;
+
+    switch(kind)
+    {
+    case nk_null:
+        return nullptr;
+
+    case nk_unit:
+        {   auto stmt_list = get_node_as<ast_stmt_list_data_t>();
+
+            int line   = int(get_int());
+            int column = int(get_int());
+
+            ret = std::make_shared<const ast_unit_data_t>(stmt_list, line, column);
+        }
+        break;
+
+    case nk_stmt_list:
+        ret = std::make_shared<ast_stmt_list_data_t>(get_list<ast_stmt_list_data_t>());
+        break;
+
+    case nk_expr_list:
+        ret = std::make_shared<ast_expr_list_data_t>(get_list<ast_expr_list_data_t>());
+        break;
+
+    case nk_stmt:
+        {   auto name = get_quark();
+
+            auto expr = get_node_as<ast_expr_base_data_t>();
+
+            ret = std::make_shared<const ast_stmt_data_t>(name, expr);
+        }
+        break;
+
+    case nk_expr_call:
+        {   auto fun_expr = get_node_as<ast_expr_base_data_t>();
+            auto arg_list = get_node_as<ast_expr_list_data_t>();
+
+            ret = std::make_shared<const ast_expr_call_data_t>(fun_expr, arg_list);
+        }
+        break;
+
+    case nk_expr_identifier:
+        ret = std::make_shared<const ast_expr_identifier_data_t>(get_quark());
+        break;
+
+    case nk_expr_integer:
+        ret = std::make_shared<const ast_expr_integer_data_t>(intptr_t(get_int()));
+        break;
+
+    case nk_expr_string:
+        ret = std::make_shared<const ast_expr_string_data_t>(std::string(get_bytes()));
+        break;
+
+    case nk_expr_char:
+        ret = std::make_shared<const ast_expr_char_data_t>(char32_t(get_uint()));
+        break;
+
+    case nk_generic:        ret = get_generic<ast_generic_data_t>();        break;
+    case nk_unit_generic:   ret = get_generic<ast_unit_generic_data_t>();   break;
+    case nk_stmt_generic:   ret = get_generic<ast_stmt_generic_data_t>();   break;
+    case nk_expr_generic:   ret = get_generic<ast_expr_generic_data_t>();   break;
+
+    case nk_generic_list:
+        {   auto tag = get_quark();
+
+            ret = std::make_shared<ast_generic_list_data_t>(tag, get_list<ast_generic_list_data_t>());
+        }
+        break;
+
+    default:
+        throw bad_format_t();
+    }
+
+    auto count = get_uint();
+
+    for (uint64_t i=0; i<count; ++i)
+    {
+        auto q = get_quark();
+
+        ret->properties[q] = get_value();
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+std::any
+reader_t::get_value(void)
+{
+    switch(get_byte())
+    {
+    case vk_size_t:     return  size_t(get_uint());
+    case vk_intptr_t:   return  intptr_t(get_int());
+    case vk_int:        return  int(get_int());
+    case vk_bool:       return  bool(get_byte());
+    case vk_char32_t:   return  char32_t(get_uint());
+    case vk_string:     return  std::string(get_bytes());
+
+    case vk_ast_base:           return  get_node();
+    case vk_ast_unit:           return  ast_unit_t(get_node_as<ast_unit_base_data_t>());
+    case vk_ast_stmt:           return  ast_stmt_t(get_node_as<ast_stmt_base_data_t>());
+    case vk_ast_stmt_list:      return  ast_stmt_list_t(get_node_as<ast_stmt_list_data_t>());
+    case vk_ast_expr:           return  ast_expr_t(get_node_as<ast_expr_base_data_t>());
+    case vk_ast_expr_list:      return  ast_expr_list_t(get_node_as<ast_expr_list_data_t>());
+    case vk_ast_generic_list:   return  ast_generic_list_t(get_node_as<ast_generic_list_data_t>());
+
+    default:
+        throw bad_format_t();
+    }
+}
+
+
+}   //- namespace
+
+
+//---------------------------------------------------------------------
+//- ...
+//---------------------------------------------------------------------
+extern "C"
+{
+
+VOIDC_DLLEXPORT_BEGIN_FUNCTION
+
+
+//---------------------------------------------------------------------
+void
+v_ast_generic_set_serializer(const ast_generic_vtable_t *vtab, size_t size,
+                             ast_generic_save_fun_t save,
+                             ast_generic_load_fun_t load,
+                             void *aux)
+{
+    if (save  &&  load)
+    {
+        generic_serializer_t gs = {vtab, size, save, load, aux};
+
+        generic_savers[vtab]       = gs;
+        generic_loaders[vtab->tag] = gs;
+    }
+    else
+    {
+        generic_savers.erase(vtab);
+        generic_loaders.erase(vtab->tag);
+    }
+}
+
+
+//---------------------------------------------------------------------
+bool
+v_ast_serialize(std::string *ret, const ast_base_t *ast)
+{
+    std::string out;
+
+    try
+    {
+        writer_t w(out);
+
+        w.put_byte(ast_serial_version);
+
+        w.put_node(*ast);
+    }
+    catch (const bad_format_t &)
+    {
+        return false;
+    }
+
+    *ret = std::move(out);
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+bool
+v_ast_deserialize(ast_base_t *ret, const char *data, size_t size)
+{
+    ast_base_t node;
+
+    try
+    {
+        reader_t r(data, size);
+
+        if (r.get_byte() != ast_serial_version)  return false;
+
+        node = r.get_node();
+
+        if (r.cur != r.end)  return false;
+    }
+    catch (const bad_format_t &)
+    {
+        return false;
+    }
+
+    *ret = std::move(node);
+
+    return true;
+}
+
+
+//---------------------------------------------------------------------
+VOIDC_DLLEXPORT_END
+
+}   //- extern "C"
@@ -0,0 +1,48 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_AST_SERIAL_H
+#define VOIDC_AST_SERIAL_H
+
+#include "voidc_ast.h"
+
+#include <string>
+
+
+//---------------------------------------------------------------------
+//- Binary AST serialization
+//---------------------------------------------------------------------
+//- Compact format: varints, quarks as strings (each one written once
+//- per tree), properties included. Built-in nodes are always supported,
+//- generic ones - only if their serializer is set (see below).
+//- Property values: size_t, intptr_t, int, bool, char32_t, std::string
+//- and AST interface types. Anything else (incl. expr_compiled and
+//- uint32_t, i.e. v_quark_t - Sic!) makes serialization fail...
+//---------------------------------------------------------------------
+extern "C"
+{
+
+typedef bool (*ast_generic_save_fun_t)(void *aux, std::string *out, const void *object);
+typedef bool (*ast_generic_load_fun_t)(void *aux, void *object, const char *data, size_t size);
+
+
+VOIDC_DLLEXPORT_BEGIN_FUNCTION
+
+//- Generic nodes: keyed by vtable (to save) and by tag (to load)...
+
+void v_ast_generic_set_serializer(const ast_generic_vtable_t *vtab, size_t size,
+                                  ast_generic_save_fun_t save,
+                                  ast_generic_load_fun_t load,
+                                  void *aux);
+
+bool v_ast_serialize(std::string *ret, const ast_base_t *ast);
+
+bool v_ast_deserialize(ast_base_t *ret, const char *data, size_t size);
+
+VOIDC_DLLEXPORT_END
+
+}   //- extern "C"
+
+
+#endif  //- VOIDC_AST_SERIAL_H
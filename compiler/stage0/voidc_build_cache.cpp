@@ -0,0 +1,428 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_build_cache.h"
+
+#include "voidc_file_util.h"
+#include "voidc_import_binary.h"
+
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------
+static std::set<std::string>
+scan_source_imports(const fs::path &src)
+{
+    std::set<std::string> ret;
+
+    std::string text;
+
+    if (auto *f = my_fopen(src))
+    {
+        char buf[4096];
+
+        while(size_t n = std::fread(buf, 1, sizeof(buf), f))  text.append(buf, n);
+
+        std::fclose(f);
+    }
+
+    auto is_ident = [](char c) { return  std::isalnum((unsigned char)c)  ||  c == '_'; };
+
+    for (const char *name : {"v_import", "voidc_import", "v_export_import", "voidc_export_import"})
+    {
+        size_t len = std::strlen(name);
+
+        for (size_t pos = text.find(name);  pos != std::string::npos;  pos = text.find(name, pos+1))
+        {
+            if (pos > 0  &&  is_ident(text[pos-1]))  continue;
+
+            size_t p = pos + len;
+
+            while(p < text.size()  &&  std::isspace((unsigned char)text[p]))  ++p;
+
+            if (p >= text.size()  ||  text[p] != '(')  continue;
+
+            ++p;
+
+            while(p < text.size()  &&  std::isspace((unsigned char)text[p]))  ++p;
+
+            if (p >= text.size()  ||  text[p] != '"')  continue;
+
+            size_t e = text.find('"', ++p);
+
+            if (e == std::string::npos)  continue;
+
+            std::string arg = text.substr(p, e-p);
+
+            if (arg.find('\\') == std::string::npos)  ret.insert(arg);      //- Plain literals only
+        }
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+//- Run a worker and wait: no shell in between (argv as is)...
+//---------------------------------------------------------------------
+#ifdef _WIN32
+
+static std::wstring
+quote_argument(const std::wstring &arg)         //- See CommandLineToArgvW
+{
+    if (!arg.empty()  &&  arg.find_first_of(L" \t\n\v\"") == std::wstring::npos)  return arg;
+
+    std::wstring ret = L"\"";
+
+    size_t slashes = 0;
+
+    for (auto c : arg)
+    {
+        if (c == L'\\')
+        {
+            ++slashes;
+        }
+        else
+        {
+            if (c == L'"')  ret.append(slashes + 1, L'\\');
+
+            slashes = 0;
+        }
+
+        ret += c;
+    }
+
+    ret.append(slashes, L'\\');
+
+    return  ret + L"\"";
+}
+
+static bool
+run_process(const std::vector<std::string> &args)
+{
+    std::wstring cmd;
+
+    for (auto &a : args)
+    {
+        if (!cmd.empty())  cmd += L' ';
+
+        cmd += quote_argument(fs::u8path(a).wstring());
+    }
+
+    STARTUPINFOW si = { sizeof(si) };
+
+    PROCESS_INFORMATION pi;
+
+    if (!CreateProcessW(nullptr, cmd.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi))
+    {
+        fprintf(stderr, "build-cache: CreateProcess failed: %lu\n", (unsigned long)GetLastError());
+
+        return false;
+    }
+
+    WaitForSingleObject(pi.hProcess, INFINITE);
+
+    DWORD code = 1;
+
+    GetExitCodeProcess(pi.hProcess, &code);
+
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+
+    return  (code == 0);
+}
+
+#else
+
+static bool
+run_process(const std::vector<std::string> &args)
+{
+    std::vector<char *> argv;
+
+    for (auto &a : args)  argv.push_back(const_cast<char *>(a.c_str()));     //- Sic!
+
+    argv.push_back(nullptr);
+
+    pid_t pid;
+
+    if (int err = posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ))
+    {
+        fprintf(stderr, "build-cache: posix_spawn failed: %s\n", std::strerror(err));
+
+        return false;
+    }
+
+    int status;
+
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)  return false;
+    }
+
+    return  WIFEXITED(status)  &&  WEXITSTATUS(status) == 0;
+}
+
+#endif
+
+
+//---------------------------------------------------------------------
+int
+build_import_cache(const std::list<std::string> &roots,
+                   const std::vector<std::string> &worker_args,
+                   int jobs,
+                   const build_cache_env_t &env)
+{
+    auto &gctx = *voidc_global_ctx_t::voidc;
+
+    struct node_t
+    {
+        std::string path;
+
+        std::vector<node_t *> deps;
+        std::vector<node_t *> users;        //- To build
+
+        bool build  = false;
+        bool failed = false;
+
+        int pending = 0;                    //- Deps to build
+    };
+
+    std::map<std::string, node_t> nodes;
+
+    auto bin_absolute = [&gctx, &env](const fs::path &src)
+    {
+        fs::path bin = env.bin_filepath(&gctx, src);
+
+        if (!bin.is_absolute())  bin = src.parent_path() / bin;
+
+        return bin;
+    };
+
+    auto imports_of = [&](const fs::path &src)
+    {
+        auto names = scan_source_imports(src);
+
+        auto bin = bin_absolute(src);
+
+        if (auto *binary = open_import_binary(bin))         //- Maybe, stale...
+        {
+            for (auto &imp : binary->imports)  names.insert(imp.first);
+
+            close_import_binary(bin);
+        }
+
+        std::vector<std::string> ret;
+
+        for (auto &name : names)
+        {
+            auto path = env.find_file(src.parent_path(), fs::u8path(name));
+
+            if (!path.empty())  ret.push_back(path.generic_u8string());
+        }
+
+        return ret;
+    };
+
+    //- Discover...
+
+    std::vector<std::string> queue;
+
+    for (auto &root : roots)
+    {
+        if (root == "-"  ||  !fs::exists(fs::u8path(root)))  continue;
+
+        for (auto &imp : imports_of(fs::canonical(fs::u8path(root))))  queue.push_back(imp);
+    }
+
+    std::vector<node_t *> order;            //- Dependencies first
+
+    {   std::map<std::string, std::vector<std::string>> imports;
+
+        while(!queue.empty())
+        {
+            auto path = std::move(queue.back());
+
+            queue.pop_back();
+
+            if (imports.count(path))  continue;
+
+            auto &imps = imports[path] = imports_of(fs::u8path(path));
+
+            for (auto &imp : imps)  queue.push_back(imp);
+        }
+
+        for (auto &it : imports)  nodes[it.first].path = it.first;
+
+        for (auto &it : imports)
+        {
+            auto &n = nodes[it.first];
+
+            for (auto &imp : it.second)  n.deps.push_back(&nodes[imp]);
+        }
+
+        std::map<node_t *, int> mark;       //- 1 - in progress, 2 - done
+
+        std::function<void(node_t *)> visit = [&](node_t *n)
+        {
+            if (mark[n])  return;           //- Done or a cycle (just ignore the edge)
+
+            mark[n] = 1;
+
+            for (auto *d : n->deps)  visit(d);
+
+            mark[n] = 2;
+
+            order.push_back(n);
+        };
+
+        for (auto &it : nodes)  visit(&it.second);
+    }
+
+    //- What to build...
+
+    int total = 0;
+
+    for (auto *n : order)
+    {
+        try
+        {
+            n->build = !env.check_import(fs::u8path(n->path), env.bin_filepath(&gctx, fs::u8path(n->path)));
+        }
+        catch (const std::exception &)
+        {
+            n->build = true;                //- The worker will tell...
+        }
+
+        for (auto *d : n->deps)
+        {
+            if (d->build)  n->build = true;
+        }
+
+        if (!n->build)  continue;
+
+        ++total;
+
+        for (auto *d : n->deps)
+        {
+            if (!d->build)  continue;
+
+            d->users.push_back(n);
+
+            n->pending += 1;
+        }
+    }
+
+    close_import_binaries();            //- Unmap, workers will rewrite them...
+
+    if (total == 0)  return 0;
+
+    //- Build...
+
+    if (jobs <= 0)  jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    jobs = std::min(jobs, total);
+
+    std::vector<std::string> command = {env.exe_path.u8string(), "--build-cache-worker", "-j1"};    //- Processes are the parallelism...
+
+    command.insert(command.end(), worker_args.begin(), worker_args.end());
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    std::vector<node_t *> ready;
+
+    for (auto *n : order)
+    {
+        if (n->build  &&  n->pending == 0)  ready.push_back(n);
+    }
+
+    int remaining = total;
+    int failed    = 0;
+
+    std::function<void(node_t *, bool)> finish = [&](node_t *n, bool ok)     //- Under lock
+    {
+        --remaining;
+
+        if (!ok)  ++failed;
+
+        for (auto *u : n->users)
+        {
+            if (!ok)  u->failed = true;
+
+            if (--u->pending > 0)  continue;
+
+            if (u->failed)  finish(u, false);
+            else            ready.push_back(u);
+        }
+    };
+
+    auto worker = [&]()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (;;)
+        {
+            cv.wait(lock, [&] { return  !ready.empty()  ||  remaining == 0; });
+
+            if (remaining == 0)  break;
+
+            auto *n = ready.back();
+
+            ready.pop_back();
+
+            lock.unlock();
+
+            if (env.trace)  printf("build:  %s\n", n->path.c_str());
+
+            auto args = command;
+
+            args.push_back(n->path);
+
+            bool ok = run_process(args);
+
+            if (!ok)  fprintf(stderr, "build-cache: failed: %s\n", n->path.c_str());
+
+            lock.lock();
+
+            finish(n, ok);
+
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (int i=0; i<jobs; ++i)  threads.emplace_back(worker);
+
+    for (auto &t : threads)  t.join();
+
+    if (env.trace)  printf("build-cache: %d imports, %d failed\n", total, failed);
+
+    return  (failed ? 1 : 0);
+}
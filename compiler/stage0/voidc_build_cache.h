@@ -0,0 +1,45 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_BUILD_CACHE_H
+#define VOIDC_BUILD_CACHE_H
+
+#include "voidc_target.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <list>
+
+
+//---------------------------------------------------------------------
+//- Import cache warm-up:  voidc --build-cache <roots...>
+//---------------------------------------------------------------------
+//- Discovers the import DAG of the roots (imports tables of existing
+//- binaries + a scan of sources for v_import("...") and friends), then
+//- compiles stale imports in worker processes ("--build-cache-worker"),
+//- dependencies first. Roots themselves are programs, not imports, so
+//- they are not compiled.
+//- Processes, not threads: voidc_global_ctx_t is global...
+//---------------------------------------------------------------------
+struct build_cache_env_t            //- Import machinery of voidc_main.cpp
+{
+    std::filesystem::path exe_path;             //- Of the workers
+
+    std::filesystem::path (*find_file)(const std::filesystem::path &parent, const std::filesystem::path &filename);
+
+    std::filesystem::path (*bin_filepath)(base_global_ctx_t *gctx, const std::filesystem::path &src_filename);
+
+    bool (*check_import)(const std::filesystem::path &src_filepath, const std::filesystem::path &bin_filepath);
+
+    bool trace = false;
+};
+
+int build_import_cache(const std::list<std::string> &roots,
+                       const std::vector<std::string> &worker_args,       //- Options for the workers
+                       int jobs,                                            //- <= 0 - all CPUs
+                       const build_cache_env_t &env);
+
+
+#endif  //- VOIDC_BUILD_CACHE_H
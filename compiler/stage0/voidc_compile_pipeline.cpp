@@ -0,0 +1,262 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_compile_pipeline.h"
+
+#include "voidc_target.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+#include <llvm-c/Target.h>
+#include <llvm-c/LLJIT.h>
+
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
+
+
+//---------------------------------------------------------------------
+using namespace llvm;
+
+
+//---------------------------------------------------------------------
+//- Target machines
+//---------------------------------------------------------------------
+LLVMTargetMachineRef
+create_target_machine(int opt_level)
+{
+    int idx = std::min(opt_level, 2);           //- O3 -> LLVMCodeGenLevelDefault (as before)
+
+    const char *triple = LLVMOrcLLJITGetTripleString(voidc_global_ctx_t::jit);
+
+    LLVMTargetRef tr;
+
+    char *errmsg = nullptr;
+
+    int err = LLVMGetTargetFromTriple(triple, &tr, &errmsg);
+
+    if (errmsg)
+    {
+        fprintf(stderr, "LLVMGetTargetFromTriple: %s\n", errmsg);
+
+        LLVMDisposeMessage(errmsg);
+
+        errmsg = nullptr;
+    }
+
+    assert(err == 0);
+
+    static const LLVMCodeGenOptLevel levels[3] =
+    {
+        LLVMCodeGenLevelNone,
+        LLVMCodeGenLevelLess,
+        LLVMCodeGenLevelDefault,
+    };
+
+    char *cpu_name     = LLVMGetHostCPUName();
+    char *cpu_features = LLVMGetHostCPUFeatures();
+
+    auto tm =
+        LLVMCreateTargetMachine
+        (
+            tr,
+            triple,
+            cpu_name,
+            cpu_features,
+            levels[idx],
+
+#ifdef _WIN32                                       //- WTF !?!
+            LLVMRelocDefault,                       //- WTF !?!
+#else                                               //- WTF !?!
+            LLVMRelocPIC,                           //- WTF !?!
+#endif                                              //- WTF !?!
+
+            LLVMCodeModelJITDefault
+        );
+
+    LLVMDisposeMessage(cpu_features);
+    LLVMDisposeMessage(cpu_name);
+
+    return tm;
+}
+
+
+//---------------------------------------------------------------------
+//- Compile pipeline
+//---------------------------------------------------------------------
+compile_pipeline_t::compile_pipeline_t(bool own_target_machines)
+  : own_target_machines(own_target_machines)
+{}
+
+compile_pipeline_t::~compile_pipeline_t()
+{
+    for (auto &lev : levels)  lev.reset();      //- Sic! Before target machines...
+
+    for (auto tm : target_machines)  if (tm) LLVMDisposeTargetMachine(tm);
+}
+
+TargetMachine *
+compile_pipeline_t::target_machine(int opt_level)
+{
+    if (!own_target_machines)  return unwrap_target_machine(voidc_global_ctx_t::get_target_machine(opt_level));
+
+    int idx = std::min(opt_level, 2);           //- See voidc_global_ctx_t::get_target_machine
+
+    auto &tm = target_machines[idx];
+
+    if (!tm)  tm = create_target_machine(opt_level);
+
+    return  unwrap_target_machine(tm);
+}
+
+//---------------------------------------------------------------------
+compile_pipeline_t::level_t::level_t(TargetMachine *tm)
+  : pb(tm)
+{
+    pb.registerModuleAnalyses(mam);
+    pb.registerCGSCCAnalyses(cgam);
+    pb.registerFunctionAnalyses(fam);
+    pb.registerLoopAnalyses(lam);
+
+    pb.crossRegisterProxies(lam, fam, cgam, mam);
+}
+
+//---------------------------------------------------------------------
+Error
+compile_pipeline_t::optimize(Module &module, int opt_level)
+{
+    auto &lev = levels[opt_level];
+
+    if (!lev)
+    {
+        static const char *pipelines[4] = { "default<O0>", "default<O1>", "default<O2>", "default<O3>" };
+
+        lev = std::make_unique<level_t>(target_machine(opt_level));
+
+        if (auto err = lev->pb.parsePassPipeline(lev->mpm, pipelines[opt_level]))
+        {
+            lev.reset();
+
+            return err;
+        }
+    }
+
+    lev->mpm.run(module, lev->mam);
+
+    //- Nothing cached may survive the module...
+
+    lev->lam.clear();
+    lev->fam.clear();
+    lev->cgam.clear();
+    lev->mam.clear();
+
+    return Error::success();
+}
+
+//---------------------------------------------------------------------
+Expected<std::unique_ptr<MemoryBuffer>>
+compile_pipeline_t::emit(Module &module, int opt_level)
+{
+    auto *tm = target_machine(opt_level);
+
+    module.setDataLayout(tm->createDataLayout());
+
+    SmallVector<char, 0> buf;
+
+    raw_svector_ostream os(buf);
+
+    legacy::PassManager pm;
+
+#if LLVM_VERSION_MAJOR < 18
+    const auto file_type = CGFT_ObjectFile;
+#else
+    const auto file_type = CodeGenFileType::ObjectFile;
+#endif
+
+    if (tm->addPassesToEmitFile(pm, os, nullptr, file_type))
+    {
+        return  createStringError(inconvertibleErrorCode(), "TargetMachine can't emit a file of this type");     //- As LLVMTargetMachineEmitToMemoryBuffer
+    }
+
+    pm.run(module);
+
+    return  std::unique_ptr<MemoryBuffer>(std::make_unique<SmallVectorMemoryBuffer>(std::move(buf), module.getModuleIdentifier(), false));
+}
+
+
+//---------------------------------------------------------------------
+//- Compile pool
+//---------------------------------------------------------------------
+compile_pool_t::compile_pool_t(unsigned workers)
+{
+    for (unsigned k = 0; k < workers; ++k)  threads.emplace_back(&compile_pool_t::worker, this);
+}
+
+compile_pool_t::~compile_pool_t()
+{
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        stopping = true;
+    }
+
+    start_cv.notify_all();
+
+    for (auto &t : threads)  t.join();
+}
+
+void
+compile_pool_t::run(size_t count_, const job_t &job_, compile_pipeline_t &own)
+{
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        job   = &job_;
+        count = count_;
+        next  = 0;
+
+        busy = size();          //- Every worker takes part in every run
+
+        ++generation;
+    }
+
+    start_cv.notify_all();
+
+    for (size_t i; (i = next++) < count; )  job_(own, i);
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    done_cv.wait(lock, [this]{ return busy == 0; });
+
+    job = nullptr;
+}
+
+void
+compile_pool_t::worker(void)
+{
+    compile_pipeline_t pipeline(true);      //- Own target machines
+
+    size_t seen = 0;
+
+    for (;;)
+    {
+        const job_t *j;
+
+        {   std::unique_lock<std::mutex> lock(mutex);
+
+            start_cv.wait(lock, [&]{ return stopping  ||  generation != seen; });
+
+            if (stopping)  return;
+
+            seen = generation;
+
+            j = job;
+        }
+
+        for (size_t i; (i = next++) < count; )  (*j)(pipeline, i);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (--busy == 0)  done_cv.notify_all();
+    }
+}
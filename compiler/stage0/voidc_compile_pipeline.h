@@ -0,0 +1,127 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_COMPILE_PIPELINE_H
+#define VOIDC_COMPILE_PIPELINE_H
+
+#include <memory>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include <llvm-c/TargetMachine.h>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+
+
+//---------------------------------------------------------------------
+//- Target machines for the JIT: its triple, host CPU and features...
+//---------------------------------------------------------------------
+LLVMTargetMachineRef create_target_machine(int opt_level);
+
+inline
+llvm::TargetMachine *
+unwrap_target_machine(LLVMTargetMachineRef tm)
+{
+    return  reinterpret_cast<llvm::TargetMachine *>(tm);
+}
+
+
+//---------------------------------------------------------------------
+//- Compile pipeline
+//---------------------------------------------------------------------
+//- Optimization: PassBuilder, analysis managers and pass pipeline are
+//- built once per level and reused (cached analyses are cleared after
+//- each module). Codegen: legacy pass manager keeps per-module MC state
+//- (streamer, assembler), so it is rebuilt, but the object goes right
+//- into a MemoryBuffer - no extra copies...
+//- Worker threads use their own pipelines with private target machines
+//- (TargetMachine is not safe to share between concurrent codegens).
+//---------------------------------------------------------------------
+class compile_pipeline_t
+{
+public:
+    explicit compile_pipeline_t(bool own_target_machines = false);
+    ~compile_pipeline_t();
+
+public:
+    llvm::Error optimize(llvm::Module &module, int opt_level);
+
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> emit(llvm::Module &module, int opt_level);
+
+private:
+    llvm::TargetMachine *target_machine(int opt_level);
+
+    const bool own_target_machines;
+
+    LLVMTargetMachineRef target_machines[3] = {};
+
+private:
+    struct level_t
+    {
+        explicit level_t(llvm::TargetMachine *tm);
+
+        llvm::LoopAnalysisManager     lam;
+        llvm::FunctionAnalysisManager fam;
+        llvm::CGSCCAnalysisManager    cgam;
+        llvm::ModuleAnalysisManager   mam;
+
+        llvm::PassBuilder pb;
+
+        llvm::ModulePassManager mpm;
+    };
+
+    std::unique_ptr<level_t> levels[4];
+};
+
+
+//---------------------------------------------------------------------
+//- Compile pool
+//---------------------------------------------------------------------
+//- Worker threads live as long as the pool, each with its own pipeline
+//- (target machines and pass managers are not shared between threads).
+//- The calling thread works too - with the pipeline it passes in...
+//---------------------------------------------------------------------
+class compile_pool_t
+{
+public:
+    using job_t = std::function<void(compile_pipeline_t &pipeline, size_t idx)>;
+
+public:
+    explicit compile_pool_t(unsigned workers);
+    ~compile_pool_t();
+
+public:
+    unsigned size(void) const { return unsigned(threads.size()); }
+
+    void run(size_t count, const job_t &job, compile_pipeline_t &own);     //- Blocks until all done
+
+private:
+    void worker(void);
+
+    std::vector<std::thread> threads;
+
+    std::mutex              mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+
+    const job_t *job   = nullptr;
+    size_t       count = 0;
+
+    std::atomic<size_t> next = 0;
+
+    size_t   generation = 0;
+    unsigned busy       = 0;
+    bool     stopping   = false;
+};
+
+
+#endif  //- VOIDC_COMPILE_PIPELINE_H
@@ -743,7 +743,7 @@ v_cast(void *, const visitor_t *vis, const ast_base_t *self)
                 {
                     const v_quark_t *pq = nullptr;
 
-                    static const v_quark_t typenames_q = v_quark_from_string("voidc.typenames_dict");
+                    constexpr v_quark_t typenames_q = v_static_quark_voidc_typenames_dict;
 
                     if (auto *i = lctx.decls.overloads.find(typenames_q))           //- WTF ?!?!?!?!?!?!?
                     {
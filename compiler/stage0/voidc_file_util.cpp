@@ -0,0 +1,111 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_file_util.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <share.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------
+file_sig_t
+file_signature(const fs::path &path)
+{
+    file_sig_t sig;
+
+    std::error_code ec;
+
+    auto st = fs::status(path, ec);
+
+    if (ec  ||  !fs::exists(st))  return sig;
+
+    sig.exists = true;
+
+    auto t = fs::last_write_time(path, ec);
+
+    if (!ec)  sig.mtime = int64_t(t.time_since_epoch().count());
+
+    if (fs::is_regular_file(st))
+    {
+        auto sz = fs::file_size(path, ec);
+
+        if (!ec)  sig.size = sz;
+    }
+
+    return sig;
+}
+
+
+//---------------------------------------------------------------------
+out_binary_t::out_binary_t(const fs::path &filename)
+  : out_path(filename),
+    tmp_path(filename)
+{
+    fs::create_directories(filename.parent_path());         //- Sic !?!
+
+    tmp_path += "_XXXXXX";
+
+    fs::path::string_type tmp_name = tmp_path.native();
+
+#ifdef _WIN32
+
+    int fd = -1;
+
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+    int len = int(tmp_name.size());
+
+    auto *template_name = tmp_name.data();
+
+    for (int i=0; i >= 0; i++)
+    {
+        for (int j=len-6; j < len; j++)
+        {
+            template_name[j] = letters[std::rand()/(RAND_MAX/61)];
+        }
+
+        fd = _wsopen(template_name,
+                     _O_RDWR|_O_CREAT|_O_EXCL|_O_BINARY,
+                     _SH_DENYRW,
+                     _S_IREAD|_S_IWRITE
+                    );
+
+        if (fd != -1  ||  errno != EEXIST) break;
+    }
+
+    assert(fd != -1);       //- ?..
+
+#else
+
+    int fd = mkstemp(tmp_name.data());
+
+#endif
+
+    tmp_path = tmp_name.c_str();
+
+    f = ::fdopen(fd, "wb");
+}
+
+out_binary_t::~out_binary_t()
+{
+    if (!f)  return;
+
+    std::fclose(f);
+
+    fs::rename(tmp_path, out_path);
+}
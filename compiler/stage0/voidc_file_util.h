@@ -0,0 +1,78 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_FILE_UTIL_H
+#define VOIDC_FILE_UTIL_H
+
+#include <filesystem>
+#include <cstdio>
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+//- Files of the import machinery: binaries, caches, manifests...
+//---------------------------------------------------------------------
+inline
+std::FILE *
+my_fopen(const std::filesystem::path &fpath, bool write=false)
+{
+
+#ifdef _WIN32
+
+    return _wfopen(fpath.c_str(), (write ? L"wb" : L"rb"));
+
+#else
+
+    return std::fopen(fpath.c_str(), (write ? "wb" : "rb"));
+
+#endif
+
+}
+
+inline
+void
+my_fread(void* buf, size_t sz, size_t cn, std::FILE* f)
+{
+    auto dummy = std::fread(buf, sz, cn, f);
+}
+
+
+//---------------------------------------------------------------------
+//- Stat signature: nonexistent files have one too...
+//---------------------------------------------------------------------
+struct file_sig_t
+{
+    int64_t  mtime  = 0;
+    uint64_t size   = 0;
+    bool     exists = false;
+
+    bool operator==(const file_sig_t &o) const
+    {
+        return  (exists == o.exists  &&  mtime == o.mtime  &&  size == o.size);
+    }
+};
+
+file_sig_t file_signature(const std::filesystem::path &path);
+
+
+//---------------------------------------------------------------------
+//- Written to a temporary file, published by rename (on destruction)...
+//---------------------------------------------------------------------
+struct out_binary_t
+{
+    explicit out_binary_t(const std::filesystem::path &filename);
+
+    ~out_binary_t();
+
+public:
+    FILE *f = nullptr;
+
+private:
+    const std::filesystem::path out_path;
+
+    std::filesystem::path tmp_path;
+};
+
+
+#endif  //- VOIDC_FILE_UTIL_H
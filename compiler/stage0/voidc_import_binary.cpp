@@ -0,0 +1,394 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_import_binary.h"
+
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#include <llvm-c/Core.h>
+
+#include <llvm/Support/Compression.h>
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+extern "C"
+LLVMValueRef v_target_global_ctx_get_constant_value(base_global_ctx_t *, v_quark_t);
+
+
+//---------------------------------------------------------------------
+const char import_binary_magic[8] = ".voidc7";
+
+//- Dynamic quark ids (baked into binaries) start right after the static
+//- ones: any change of voidc_quark_table.h must bump the magic above...
+
+static_assert(v_static_quark_next == 95, "Quark table changed - bump the import binary magic and this count!");
+
+
+//---------------------------------------------------------------------
+//- Records compression
+//---------------------------------------------------------------------
+static bool
+record_codec_format(uint64_t codec, llvm::compression::Format &format)
+{
+    switch(codec)
+    {
+    case record_codec_zlib:  format = llvm::compression::Format::Zlib;  return true;
+    case record_codec_zstd:  format = llvm::compression::Format::Zstd;  return true;
+
+    default:
+        return false;
+    }
+}
+
+uint64_t
+obtain_record_codec(base_global_ctx_t *gctx)
+{
+    auto *name = (const char *)v_target_global_ctx_get_constant_value(gctx, v_static_quark_voidc_import_compression);
+
+    if (!name)  return record_codec_none;
+
+    uint64_t codec = record_codec_none;
+
+    if (std::strcmp(name, "zlib") == 0)  codec = record_codec_zlib;
+    if (std::strcmp(name, "zstd") == 0)  codec = record_codec_zstd;
+
+    llvm::compression::Format format;
+
+    if (!record_codec_format(codec, format)  ||
+        llvm::compression::getReasonIfUnsupported(format))  return record_codec_none;     //- Not built in LLVM...
+
+    return codec;
+}
+
+bool
+decompress_record(const unit_header_t &h, const char *data, size_t len, llvm::SmallVectorImpl<uint8_t> &raw)
+{
+    llvm::compression::Format format;
+
+    if (!record_codec_format(h.codec, format))  return false;
+
+    auto err = llvm::compression::decompress(format, llvm::ArrayRef<uint8_t>((const uint8_t *)data, len), raw, h.raw_size);
+
+    if (err)
+    {
+        llvm::consumeError(std::move(err));
+
+        return false;
+    }
+
+    return  (raw.size() == h.raw_size);
+}
+
+//---------------------------------------------------------------------
+void
+record_writer_t::write(unit_header_t h, const char *buf, size_t buf_len)
+{
+    static const char padding[8] = {};
+
+    llvm::SmallVector<uint8_t, 0> packed;
+
+    h.codec    = record_codec_none;
+    h.raw_size = buf_len;
+
+    llvm::compression::Format format;
+
+    if (buf_len >= 256  &&  record_codec_format(codec, format))        //- Small ones - as is
+    {
+        llvm::compression::compress(format, llvm::ArrayRef<uint8_t>((const uint8_t *)buf, buf_len), packed);
+
+        if (packed.size() < buf_len)
+        {
+            h.codec = codec;
+
+            buf     = (const char *)packed.data();
+            buf_len = packed.size();
+        }
+    }
+
+    size_t len = sizeof(h) + buf_len;
+
+    std::fwrite((char *)&len, sizeof(len), 1, f);
+
+    std::fwrite((char *)&h, sizeof(h), 1, f);
+
+    if (buf_len)  std::fwrite(buf, buf_len, 1, f);
+
+    std::fwrite(padding, align_unit_size(len) - len, 1, f);
+}
+
+void
+put_module_record(void *aux, const char *buf, size_t len, bool lazy)
+{
+    unit_header_t h = {};
+
+    h.kind = (lazy ? unit_record_module_lazy : unit_record_module);
+
+    static_cast<record_writer_t *>(aux)->write(h, buf, len);
+}
+
+
+//---------------------------------------------------------------------
+//- Replay
+//---------------------------------------------------------------------
+void
+replay_unit_records(voidc_local_ctx_t &lctx, const char *p, const char *end)
+{
+    struct record_t
+    {
+        unit_header_t h;
+
+        const char *data;
+        size_t      len;
+
+        llvm::SmallVector<uint8_t, 0> raw;      //- Decompressed
+    };
+
+    std::vector<record_t> records;
+
+    std::vector<size_t> packed;             //- Compressed ones
+
+    while(end - p >= ptrdiff_t(sizeof(size_t)))
+    {
+        size_t len;
+
+        std::memcpy(&len, p, sizeof(len));
+
+        p += sizeof(len);
+
+        if (len < sizeof(unit_header_t)  ||  size_t(end - p) < len)  break;
+
+        auto &r = records.emplace_back();
+
+        std::memcpy(&r.h, p, sizeof(r.h));
+
+        r.data = p + sizeof(unit_header_t);
+        r.len  = len - sizeof(unit_header_t);
+
+        if (r.h.codec != record_codec_none)  packed.push_back(records.size() - 1);
+
+        p += std::min(align_unit_size(len), size_t(end - p));
+    }
+
+    //- Decompression...
+
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    std::vector<char> ready(records.size(), 1);     //- 1 - ready, 2 - broken
+
+    for (auto i : packed)  ready[i] = 0;
+
+    std::atomic<size_t> next = 0;
+
+    auto worker = [&]()
+    {
+        for (size_t k; (k = next.fetch_add(1)) < packed.size(); )
+        {
+            auto &r = records[packed[k]];
+
+            bool ok = decompress_record(r.h, r.data, r.len, r.raw);
+
+            {   std::lock_guard<std::mutex> lock(mutex);
+
+                ready[packed[k]] = (ok ? 1 : 2);
+            }
+
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    {   size_t n = std::max(2u, std::thread::hardware_concurrency()) - 1;         //- This one replays
+
+        n = std::min(n, packed.size());
+
+        for (size_t i=0; i<n; ++i)  threads.emplace_back(worker);
+    }
+
+    //- Replay...
+
+    voidc_local_ctx_t::module_records_t module_records;
+
+    std::vector<LLVMMemoryBufferRef> buffers;       //- Views, in batches (see run_unit_actions)
+
+    auto flush = [&]()
+    {
+        lctx.run_unit_actions(buffers);
+
+        for (auto buf : buffers)  LLVMDisposeMemoryBuffer(buf);
+
+        buffers.clear();
+    };
+
+    lctx.module_records = &module_records;
+
+    bool broken = false;
+
+    for (size_t i=0; i < records.size(); ++i)
+    {
+        auto &r = records[i];
+
+        const char *data = r.data;
+        size_t      len  = r.len;
+
+        if (r.h.codec != record_codec_none)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (!ready[i])
+            {
+                lock.unlock();
+
+                flush();            //- Run what we have, meanwhile...
+
+                lock.lock();
+
+                cv.wait(lock, [&] { return  ready[i] != 0; });
+            }
+
+            if (ready[i] != 1)
+            {
+                broken = true;
+
+                break;
+            }
+
+            data = (const char *)r.raw.data();
+            len  = r.raw.size();
+        }
+
+        if (is_module_record(r.h.kind))
+        {
+            module_records.views.emplace_back(data, len);
+        }
+        else if (len)
+        {
+            buffers.push_back(LLVMCreateMemoryBufferWithMemoryRange(data, len, "unit_buffer", false));
+        }
+    }
+
+    if (!broken)  flush();
+
+    lctx.module_records = nullptr;
+
+    next = packed.size();           //- Stop them...
+
+    for (auto &t : threads)  t.join();
+
+    if (broken)
+    {
+        for (auto buf : buffers)  LLVMDisposeMemoryBuffer(buf);
+
+        throw std::runtime_error("Broken import binary record");
+    }
+}
+
+
+//---------------------------------------------------------------------
+//- Mapped binaries
+//---------------------------------------------------------------------
+static
+std::map<std::string, std::unique_ptr<import_binary_t>> import_binaries;       //- By absolute path
+
+import_binary_t *
+open_import_binary(const fs::path &bin_absolute)
+{
+    auto key = bin_absolute.generic_u8string();
+
+    if (auto it = import_binaries.find(key);  it != import_binaries.end())  return it->second.get();
+
+    auto buf = llvm::MemoryBuffer::getFile(bin_absolute.u8string(), false, false);      //- Binary, no '\0'
+
+    if (!buf)  return nullptr;
+
+    auto ret = std::make_unique<import_binary_t>();
+
+    ret->buffer = std::move(*buf);
+
+    const char *start = ret->buffer->getBufferStart();
+    const char *end   = ret->buffer->getBufferEnd();
+
+    auto read_size = [&end](const char *&p, size_t &len)
+    {
+        if (end - p < ptrdiff_t(sizeof(size_t)))  return false;
+
+        std::memcpy(&len, p, sizeof(size_t));
+
+        p += sizeof(size_t);
+
+        return true;
+    };
+
+    //- Header...
+
+    size_t imports_pos;
+
+    if (end - start < ptrdiff_t(sizeof(import_binary_magic) + sizeof(size_t)))  return nullptr;
+
+    if (std::memcmp(start, import_binary_magic, sizeof(import_binary_magic)) != 0)  return nullptr;
+
+    const char *p = start + sizeof(import_binary_magic);
+
+    read_size(p, imports_pos);
+
+    ret->units = p;
+
+    if (imports_pos < size_t(p - start)  ||  imports_pos > size_t(end - start))  return nullptr;
+
+    //- Imports...
+
+    p = start + imports_pos;
+
+    for (;;)
+    {
+        size_t len;
+
+        if (!read_size(p, len))  return nullptr;
+
+        if (len == 0)  break;
+
+        if (size_t(end - p) < len)  return nullptr;
+
+        std::string src(p, len);
+
+        p += len;
+
+        if (!read_size(p, len)  ||  size_t(end - p) < len)  return nullptr;
+
+        ret->imports.emplace_back(std::move(src), std::string(p, len));
+
+        p += len;
+    }
+
+    auto *bin = ret.get();
+
+    import_binaries[key] = std::move(ret);
+
+    return bin;
+}
+
+void
+close_import_binary(const fs::path &bin_absolute)
+{
+    import_binaries.erase(bin_absolute.generic_u8string());
+}
+
+void
+close_import_binaries(void)
+{
+    for (auto &it : import_binaries)  it.second.reset();        //- Unmap
+
+    import_binaries.clear();
+}
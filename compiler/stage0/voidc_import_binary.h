@@ -0,0 +1,134 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_IMPORT_BINARY_H
+#define VOIDC_IMPORT_BINARY_H
+
+#include "voidc_target.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdio>
+#include <cstdint>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+
+//---------------------------------------------------------------------
+//- Import binaries
+//---------------------------------------------------------------------
+//- File: magic, size_t position of imports, records: size_t len (0 - end),
+//- then len bytes: unit header + unit buffer (may be empty) or module
+//- object, padded to 8 (objects must stay aligned), imports: pairs of
+//- strings (size_t len, then bytes), size_t 0 - end.
+//- Module objects (see voidc_compile_load_object_file_to_jit) precede
+//- their unit, unit actions refer to them by index, i.e. in order.
+//- Lazy-ready modules (written with -L) are bitcode, tagged by their
+//- record kind: they are compiled on load when replayed without -L...
+//- Records may be compressed ("voidc.import_compression" constant:
+//- "zstd" or "zlib"), each one has its codec in the header.
+//- Binaries are mapped once (check, then replay) and read in place.
+//- They are published by rename (see out_binary_t), so a mapping
+//- never sees a partially written file...
+//- Unit headers let a stale binary (only the source changed) be replayed
+//- up to the first changed unit, see v_import_helper (voidc_main.cpp).
+//---------------------------------------------------------------------
+extern const char import_binary_magic[8];
+
+inline
+size_t
+align_unit_size(size_t len)
+{
+    return  (len + 7) & ~size_t(7);
+}
+
+enum unit_record_kind_t
+{
+    unit_record_unit,
+    unit_record_module,
+    unit_record_module_lazy,    //- Bitcode, see voidc_compile_load_object_file_to_jit
+};
+
+inline
+bool
+is_module_record(uint64_t kind)
+{
+    return  (kind == unit_record_module  ||  kind == unit_record_module_lazy);
+}
+
+struct unit_header_t            //- Like the parse cache header...
+{
+    size_t start;
+    size_t end;
+    size_t extent;
+
+    uint64_t text_hash;         //- Of the text [start, extent)
+    uint64_t grammar_fp;        //- Unit key at start, see grammar_env_t
+
+    uint64_t kind;              //- See unit_record_kind_t (modules - just it)
+
+    uint64_t codec;             //- See record_codec_t
+    uint64_t raw_size;          //- Decompressed, if any
+};
+
+
+//---------------------------------------------------------------------
+//- Records compression
+//---------------------------------------------------------------------
+enum record_codec_t
+{
+    record_codec_none,
+    record_codec_zlib,
+    record_codec_zstd,
+};
+
+uint64_t obtain_record_codec(base_global_ctx_t *gctx);     //- See "voidc.import_compression"
+
+bool decompress_record(const unit_header_t &h, const char *data, size_t len, llvm::SmallVectorImpl<uint8_t> &raw);
+
+//---------------------------------------------------------------------
+struct record_writer_t
+{
+    std::FILE *f;
+
+    uint64_t codec = record_codec_none;
+
+public:
+    void write(unit_header_t h, const char *buf, size_t buf_len);
+};
+
+void put_module_record(void *aux, const char *buf, size_t len, bool lazy);     //- See voidc_local_ctx_t::module_records_t
+
+
+//---------------------------------------------------------------------
+//- Replay: compressed records are decompressed by worker threads (in
+//- order), while the ones before them are already running...
+//---------------------------------------------------------------------
+void replay_unit_records(voidc_local_ctx_t &lctx, const char *p, const char *end);
+
+
+//---------------------------------------------------------------------
+//- Mapped binaries
+//---------------------------------------------------------------------
+struct import_binary_t
+{
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+
+    const char *units = nullptr;            //- First unit record
+
+    std::vector<std::pair<std::string, std::string>> imports;       //- (source, binary) "as is"
+};
+
+import_binary_t *open_import_binary(const std::filesystem::path &bin_absolute);      //- Cached, by absolute path
+
+void close_import_binary(const std::filesystem::path &bin_absolute);
+
+void close_import_binaries(void);           //- All of them (unmapped)
+
+
+#endif  //- VOIDC_IMPORT_BINARY_H
@@ -0,0 +1,263 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_import_cas.h"
+
+#include "voidc_file_util.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include <llvm-c/TargetMachine.h>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/BLAKE3.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------
+extern "C"
+LLVMValueRef v_target_global_ctx_get_constant_value(base_global_ctx_t *, v_quark_t);
+
+
+//---------------------------------------------------------------------
+void
+import_cas_t::initialize(const fs::path &_exe_path, const std::string &_options_key, resolve_fun_t _resolve)
+{
+    exe_path    = _exe_path;
+    options_key = _options_key;
+    resolve     = _resolve;
+}
+
+//---------------------------------------------------------------------
+fs::path
+import_cas_t::cache_dir(base_global_ctx_t *gctx)
+{
+    if (auto d = std::getenv("VOIDC_CACHE_DIR");  d && *d)  return fs::u8path(d);
+
+    if (auto p = v_target_global_ctx_get_constant_value(gctx, v_static_quark_voidc_import_cache_dir))
+    {
+        return  fs::u8path((const char *)p);
+    }
+
+    return {};
+}
+
+static std::string
+ca_hex(llvm::BLAKE3 &h)
+{
+    auto r = h.final<20>();
+
+    return  llvm::toHex(r, true);
+}
+
+//---------------------------------------------------------------------
+//- Executable's bytes are its build id, but hashing them (tens of MB
+//- with LLVM) on each start defeats the cache. The hash is kept in the
+//- cache dir: exe-<H(path, file id, size, mtime)>.key, where path is
+//- the resolved one and file id is (device, inode/file index)...
+//---------------------------------------------------------------------
+std::string
+import_cas_t::exe_key(const fs::path &dir)
+{
+    auto sig = file_signature(exe_path);
+
+    llvm::sys::fs::UniqueID uid;
+
+    if (llvm::sys::fs::getUniqueID(exe_path.u8string(), uid))  uid = {};    //- Sic!
+
+    fs::path memo_path;
+
+    {   llvm::BLAKE3 h;
+
+        h.update(exe_path.generic_u8string());
+
+        uint64_t dev = uid.getDevice();
+        uint64_t ino = uid.getFile();
+
+        h.update(llvm::StringRef((const char *)&dev, sizeof(dev)));
+        h.update(llvm::StringRef((const char *)&ino, sizeof(ino)));
+
+        h.update(llvm::StringRef((const char *)&sig.mtime, sizeof(sig.mtime)));
+        h.update(llvm::StringRef((const char *)&sig.size,  sizeof(sig.size)));
+
+        memo_path = dir / ("exe-" + ca_hex(h) + ".key");
+    }
+
+    if (auto buf = llvm::MemoryBuffer::getFile(memo_path.u8string(), false, false))
+    {
+        if ((*buf)->getBufferSize() == 40)  return (*buf)->getBuffer().str();       //- 20 bytes, hex
+    }
+
+    llvm::BLAKE3 h;
+
+    if (auto buf = llvm::MemoryBuffer::getFile(exe_path.u8string(), false, false))
+    {
+        h.update((*buf)->getBuffer());
+    }
+
+    auto key = ca_hex(h);
+
+    {   std::error_code ec;
+
+        fs::create_directories(dir, ec);
+
+        if (ec)  return key;            //- Next time, then...
+    }
+
+    out_binary_t out(memo_path);
+
+    if (out.f)  std::fwrite(key.data(), key.size(), 1, out.f);
+
+    return key;
+}
+
+const std::string &
+import_cas_t::config_key(const fs::path &dir)
+{
+    if (!config.empty())  return config;
+
+    llvm::BLAKE3 h;
+
+    h.update(exe_key(dir));          //- Build id
+
+    char *triple       = LLVMGetDefaultTargetTriple();
+    char *cpu_name     = LLVMGetHostCPUName();
+    char *cpu_features = LLVMGetHostCPUFeatures();
+
+    for (const char *str : {(const char *)triple, (const char *)cpu_name, (const char *)cpu_features})
+    {
+        h.update(llvm::StringRef(str, std::strlen(str) + 1));
+    }
+
+    LLVMDisposeMessage(cpu_features);
+    LLVMDisposeMessage(cpu_name);
+    LLVMDisposeMessage(triple);
+
+    h.update(options_key);
+
+    config = ca_hex(h);
+
+    return config;
+}
+
+const std::string &
+import_cas_t::source_key(const fs::path &dir, const fs::path &src_filepath)
+{
+    auto [it, ok] = source_keys.try_emplace(src_filepath.generic_u8string());
+
+    if (!ok)  return it->second;
+
+    llvm::BLAKE3 h;
+
+    h.update(config_key(dir));
+
+    if (auto buf = llvm::MemoryBuffer::getFile(src_filepath.u8string(), false, false))
+    {
+        h.update((*buf)->getBuffer());
+    }
+
+    it->second = ca_hex(h);
+
+    return it->second;
+}
+
+std::string
+import_cas_t::full_key(const fs::path &dir, const fs::path &src_filepath)
+{
+    auto [it, ok] = full_keys.try_emplace(src_filepath.generic_u8string());
+
+    if (!ok)  return it->second;            //- Also breaks cycles ("")
+
+    auto &src_key = source_key(dir, src_filepath);
+
+    auto buf = llvm::MemoryBuffer::getFile((dir / (src_key + ".deps")).u8string(), false, false);
+
+    if (!buf)  return "";
+
+    llvm::BLAKE3 h;
+
+    h.update(src_key);
+
+    auto parent_path = src_filepath.parent_path();
+
+    const char *p   = (*buf)->getBufferStart();
+    const char *end = (*buf)->getBufferEnd();
+
+    while(p < end)
+    {
+        size_t len;
+
+        if (size_t(end - p) < sizeof(len))  return "";
+
+        std::memcpy(&len, p, sizeof(len));
+
+        p += sizeof(len);
+
+        if (size_t(end - p) < len)  return "";
+
+        auto imp_filepath = resolve(parent_path, fs::u8path(std::string(p, len)));
+
+        p += len;
+
+        if (imp_filepath.empty())  return "";
+
+        auto imp_key = full_key(dir, imp_filepath);
+
+        if (imp_key.empty())  return "";
+
+        h.update(imp_key);
+    }
+
+    auto key = ca_hex(h);
+
+    full_keys[src_filepath.generic_u8string()] = key;        //- Sic! "it" may be invalid
+
+    return key;
+}
+
+void
+import_cas_t::publish(const fs::path &dir,
+                      const fs::path &src_filepath,
+                      const std::set<std::pair<std::string, std::string>> &imports,
+                      const fs::path &bin_absolute)
+{
+    auto &src_key = source_key(dir, src_filepath);
+
+    {   out_binary_t out(dir / (src_key + ".deps"));
+
+        for (auto &imp : imports)
+        {
+            size_t len = imp.first.size();
+
+            std::fwrite(&len, sizeof(len), 1, out.f);
+
+            std::fwrite(imp.first.data(), len, 1, out.f);
+        }
+    }
+
+    full_keys.erase(src_filepath.generic_u8string());        //- Was "unknown"
+
+    auto key = full_key(dir, src_filepath);
+
+    if (key.empty())  return;       //- Some import is not in the cache (another target?)
+
+    auto bin_ca = dir / (key + ".voidc");
+
+    if (fs::exists(bin_ca))  return;
+
+    auto buf = llvm::MemoryBuffer::getFile(bin_absolute.u8string(), false, false);
+
+    if (!buf)  return;
+
+    out_binary_t out(bin_ca);
+
+    std::fwrite((*buf)->getBufferStart(), (*buf)->getBufferSize(), 1, out.f);
+}
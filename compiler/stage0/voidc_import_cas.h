@@ -0,0 +1,68 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_IMPORT_CAS_H
+#define VOIDC_IMPORT_CAS_H
+
+#include "voidc_target.h"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <map>
+#include <set>
+
+
+//---------------------------------------------------------------------
+//- Content-addressed import cache
+//---------------------------------------------------------------------
+//- Enabled by $VOIDC_CACHE_DIR or the "voidc.import_cache_dir" constant
+//- (shared by checkouts, workspaces, users...). Files there:
+//-   <source key>.deps  - imports of the source (names "as is"),
+//-   <full key>.voidc   - import binary,
+//-   exe-<...>.key      - hash of the voidc executable (see import_cas_t::exe_key).
+//- Source key: H(config, source bytes), config: H(voidc executable,
+//- triple, host CPU and features, command line options). Full key:
+//- H(source key, full keys of imports). No mtimes at all. Files are
+//- published by rename: concurrent writers race harmlessly, readers
+//- (mappings) never see partial files. Voidc target only...
+//---------------------------------------------------------------------
+struct import_cas_t
+{
+    typedef std::filesystem::path (*resolve_fun_t)(const std::filesystem::path &parent, const std::filesystem::path &filename);
+
+    void initialize(const std::filesystem::path &exe_path, const std::string &options_key, resolve_fun_t resolve);
+
+public:
+    static std::filesystem::path cache_dir(base_global_ctx_t *gctx);      //- Empty - disabled
+
+    std::string full_key(const std::filesystem::path &dir, const std::filesystem::path &src_filepath);     //- "" - unknown
+
+    void publish(const std::filesystem::path &dir,
+                 const std::filesystem::path &src_filepath,
+                 const std::set<std::pair<std::string, std::string>> &imports,      //- See voidc_local_ctx_t
+                 const std::filesystem::path &bin_absolute);
+
+private:
+    std::filesystem::path exe_path;
+
+    std::string options_key;
+
+    resolve_fun_t resolve = nullptr;        //- See find_file_for_import (voidc_main.cpp)
+
+    std::string config;
+
+    std::map<std::string, std::string> source_keys;     //- Source path -> key
+    std::map<std::string, std::string> full_keys;       //- Source path -> key ("" - unknown)
+
+private:
+    std::string exe_key(const std::filesystem::path &dir);
+
+    const std::string &config_key(const std::filesystem::path &dir);
+
+    const std::string &source_key(const std::filesystem::path &dir, const std::filesystem::path &src_filepath);
+};
+
+
+#endif  //- VOIDC_IMPORT_CAS_H
@@ -0,0 +1,229 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_import_manifest.h"
+
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------
+//- Import manifest: file
+//---------------------------------------------------------------------
+//- Magic, import paths (as a key), then three tables, each one is
+//- size_t count + records: files (path, mtime, size, exists),
+//- resolutions (parent, name, path), imports (source, binary).
+//- Strings: size_t len, then bytes...
+//---------------------------------------------------------------------
+static
+const char manifest_magic[8] = ".vman1";
+
+//---------------------------------------------------------------------
+bool
+import_manifest_t::validate(void) const
+{
+    std::vector<std::pair<const std::string *, const file_sig_t *>> v;
+
+    v.reserve(files.size());
+
+    for (auto &it : files)  v.push_back({&it.first, &it.second});
+
+    std::atomic<bool>   ok   = true;
+    std::atomic<size_t> next = 0;
+
+    auto worker = [&]()
+    {
+        for (size_t i; ok  &&  (i = next.fetch_add(64)) < v.size(); )
+        {
+            for (size_t j = i; ok  &&  j < std::min(i+64, v.size()); ++j)
+            {
+                if (!(file_signature(fs::u8path(*v[j].first)) == *v[j].second))  ok = false;
+            }
+        }
+    };
+
+    size_t n = std::min<size_t>(std::thread::hardware_concurrency(), v.size() / 256);
+
+    std::vector<std::thread> threads;
+
+    for (size_t k = 1; k < n; ++k)  threads.emplace_back(worker);
+
+    worker();
+
+    for (auto &t : threads)  t.join();
+
+    return ok;
+}
+
+void
+import_manifest_t::load(const fs::path &_filepath, const std::string &_paths_key)
+{
+    filepath  = _filepath;
+    paths_key = _paths_key;
+
+    auto buf = llvm::MemoryBuffer::getFile(filepath.u8string(), false, false);
+
+    if (!buf)  return;
+
+    const char *p   = (*buf)->getBufferStart();
+    const char *end = (*buf)->getBufferEnd();
+
+    auto read = [&p, &end](void *data, size_t len)
+    {
+        if (size_t(end - p) < len)  return false;
+
+        std::memcpy(data, p, len);
+
+        p += len;
+
+        return true;
+    };
+
+    auto read_string = [&p, &end, &read](std::string &str)
+    {
+        size_t len;
+
+        if (!read(&len, sizeof(len))  ||  size_t(end - p) < len)  return false;
+
+        str.assign(p, len);
+
+        p += len;
+
+        return true;
+    };
+
+    auto parse = [&]()
+    {
+        char m[sizeof(manifest_magic)];
+
+        if (!read(m, sizeof(m))  ||  std::memcmp(m, manifest_magic, sizeof(m)) != 0)  return false;
+
+        std::string str;
+
+        if (!read_string(str)  ||  str != paths_key)  return false;
+
+        size_t count;
+
+        if (!read(&count, sizeof(count)))  return false;
+
+        for (size_t i=0; i<count; ++i)
+        {
+            file_sig_t sig;
+
+            if (!read_string(str)  ||
+                !read(&sig.mtime,  sizeof(sig.mtime))  ||
+                !read(&sig.size,   sizeof(sig.size))   ||
+                !read(&sig.exists, sizeof(sig.exists)))  return false;
+
+            files[str] = sig;
+        }
+
+        if (!read(&count, sizeof(count)))  return false;
+
+        for (size_t i=0; i<count; ++i)
+        {
+            key_t key;
+
+            if (!read_string(key.first)  ||  !read_string(key.second)  ||  !read_string(str))  return false;
+
+            resolutions[key] = str;
+        }
+
+        if (!read(&count, sizeof(count)))  return false;
+
+        for (size_t i=0; i<count; ++i)
+        {
+            key_t key;
+
+            if (!read_string(key.first)  ||  !read_string(key.second))  return false;
+
+            imports.insert(key);
+        }
+
+        return true;
+    };
+
+    if (!parse()  ||  !validate())
+    {
+        files.clear();
+        resolutions.clear();
+        imports.clear();
+
+        dirty = true;
+    }
+}
+
+void
+import_manifest_t::save(void)
+{
+    if (filepath.empty()  ||  !dirty)  return;
+
+    {   std::error_code ec;
+
+        fs::create_directories(filepath.parent_path(), ec);
+
+        if (ec)  return;            //- Just a cache (read-only place?)...
+    }
+
+    out_binary_t out(filepath);
+
+    if (!out.f)  return;
+
+    auto f = out.f;
+
+    auto write_size = [f](size_t len)
+    {
+        std::fwrite(&len, sizeof(len), 1, f);
+    };
+
+    auto write_string = [f, &write_size](const std::string &str)
+    {
+        write_size(str.size());
+
+        std::fwrite(str.data(), str.size(), 1, f);
+    };
+
+    std::fwrite(manifest_magic, sizeof(manifest_magic), 1, f);
+
+    write_string(paths_key);
+
+    write_size(files.size());
+
+    for (auto &it : files)
+    {
+        write_string(it.first);
+
+        std::fwrite(&it.second.mtime,  sizeof(it.second.mtime),  1, f);
+        std::fwrite(&it.second.size,   sizeof(it.second.size),   1, f);
+        std::fwrite(&it.second.exists, sizeof(it.second.exists), 1, f);
+    }
+
+    write_size(resolutions.size());
+
+    for (auto &it : resolutions)
+    {
+        write_string(it.first.first);
+        write_string(it.first.second);
+        write_string(it.second);
+    }
+
+    write_size(imports.size());
+
+    for (auto &key : imports)
+    {
+        write_string(key.first);
+        write_string(key.second);
+    }
+
+    dirty = false;
+}
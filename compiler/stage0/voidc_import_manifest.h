@@ -0,0 +1,98 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_IMPORT_MANIFEST_H
+#define VOIDC_IMPORT_MANIFEST_H
+
+#include "voidc_file_util.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <utility>
+#include <map>
+#include <set>
+
+
+//---------------------------------------------------------------------
+//- Import manifest
+//---------------------------------------------------------------------
+//- One file per root source: <binary>.manifest (like the parse cache).
+//- Records import path resolutions (with all paths probed on the way),
+//- good (source, binary) pairs and stat signatures of every file those
+//- depend on. On a warm start, one (parallel) stat pass over these
+//- files validates the whole import closure: no probing, no binary
+//- opens. Any mismatch - the manifest is dropped as a whole and
+//- rebuilt from this run's checks...
+//---------------------------------------------------------------------
+struct import_manifest_t
+{
+    using key_t = std::pair<std::string, std::string>;
+
+    void load(const std::filesystem::path &filepath, const std::string &paths_key);     //- See import_paths_key (voidc_main.cpp)
+    void save(void);
+
+    const std::string *find_resolution(const key_t &key) const
+    {
+        auto it = resolutions.find(key);
+
+        if (it == resolutions.end())  return nullptr;
+
+        return  &it->second;
+    }
+
+    void add_resolution(const key_t &key, const std::filesystem::path &resolved, const std::vector<std::filesystem::path> &probed)
+    {
+        if (filepath.empty())  return;
+
+        for (auto &p : probed)  add_file(p);
+
+        resolutions[key] = resolved.generic_u8string();
+
+        dirty = true;
+    }
+
+    void add_import(const key_t &key, const std::filesystem::path &src, const std::filesystem::path &bin)
+    {
+        if (filepath.empty())  return;
+
+        add_file(src);
+        add_file(bin);
+
+        if (imports.insert(key).second)  dirty = true;
+    }
+
+    const std::set<key_t> &good_imports(void) const     //- Loaded (valid) or added
+    {
+        return imports;
+    }
+
+private:
+    void add_file(const std::filesystem::path &path)
+    {
+        auto key = path.generic_u8string();
+
+        if (files.count(key))  return;
+
+        files[key] = file_signature(path);
+
+        dirty = true;
+    }
+
+    bool validate(void) const;
+
+private:
+    std::filesystem::path filepath;
+
+    std::string paths_key;         //- Import paths, a manifest is valid for them only
+
+    bool dirty = false;
+
+    std::map<std::string, file_sig_t> files;
+    std::map<key_t, std::string>      resolutions;      //- (parent, name) -> canonical path
+    std::set<key_t>                   imports;          //- Good (source, binary)
+};
+
+
+#endif  //- VOIDC_IMPORT_MANIFEST_H
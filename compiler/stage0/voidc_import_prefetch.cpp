@@ -0,0 +1,105 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_import_prefetch.h"
+
+#include "voidc_file_util.h"
+
+#include <cstdio>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------
+void
+import_prefetcher_t::push(const fs::path &path)
+{
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        if (stopped)  return;
+
+        if (!seen.insert(path.generic_u8string()).second)  return;
+
+        queue.push_back(path);
+
+        if (!thread.joinable())  thread = std::thread(&import_prefetcher_t::run, this);
+    }
+
+    cv.notify_one();
+}
+
+void
+import_prefetcher_t::stop(void)
+{
+    {   std::lock_guard<std::mutex> lock(mutex);
+
+        stopped = true;
+
+        queue.clear();
+    }
+
+    cv.notify_one();
+
+    if (thread.joinable())  thread.join();
+}
+
+//---------------------------------------------------------------------
+void
+import_prefetcher_t::run(void)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        cv.wait(lock, [this] { return  stopped  ||  !queue.empty(); });
+
+        if (stopped)  break;
+
+        auto path = std::move(queue.front());       //- FIFO: in the order of imports
+
+        queue.erase(queue.begin());
+
+        lock.unlock();
+
+        prefetch(path);
+
+        lock.lock();
+    }
+}
+
+void
+import_prefetcher_t::prefetch(const fs::path &path)
+{
+
+#ifdef __linux__
+
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)  return;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);       //- Starts readahead, doesn't wait
+
+    close(fd);
+
+#else
+
+    if (auto *f = my_fopen(path))           //- Just read it through...
+    {
+        static char buf[65536];
+
+        while(std::fread(buf, 1, sizeof(buf), f) == sizeof(buf));
+
+        std::fclose(f);
+    }
+
+#endif
+
+}
@@ -0,0 +1,56 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_IMPORT_PREFETCH_H
+#define VOIDC_IMPORT_PREFETCH_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+//---------------------------------------------------------------------
+//- Import binaries prefetch
+//---------------------------------------------------------------------
+//- As soon as an imports table is known, binaries of the imports are
+//- read ahead by a background thread, so the replay (mapping) finds
+//- them in the page cache. Hints only: the thread shares nothing with
+//- the main one but the queue...
+//---------------------------------------------------------------------
+struct import_prefetcher_t
+{
+    ~import_prefetcher_t()
+    {
+        stop();
+    }
+
+public:
+    void push(const std::filesystem::path &path);
+
+    void stop(void);
+
+private:
+    std::mutex mutex;
+
+    std::condition_variable cv;
+
+    std::vector<std::filesystem::path>  queue;
+    std::set<std::string>  seen;
+
+    std::thread thread;
+
+    bool stopped = false;
+
+private:
+    void run(void);
+
+    static void prefetch(const std::filesystem::path &path);
+};
+
+
+#endif  //- VOIDC_IMPORT_PREFETCH_H
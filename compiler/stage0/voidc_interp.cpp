@@ -0,0 +1,1062 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_interp.h"
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+namespace
+{
+
+//---------------------------------------------------------------------
+constexpr unsigned max_call_args = 8;
+
+
+//---------------------------------------------------------------------
+//- Intrinsics
+//---------------------------------------------------------------------
+enum intrinsic_kind_t
+{
+    intrinsic_none,             //- Not an intrinsic at all
+    intrinsic_unknown,
+
+    intrinsic_nop,
+    intrinsic_stacksave,
+    intrinsic_stackrestore,
+    intrinsic_memcpy,
+    intrinsic_memmove,
+    intrinsic_memset,
+};
+
+intrinsic_kind_t
+get_intrinsic_kind(LLVMValueRef fun)
+{
+    if (!LLVMGetIntrinsicID(fun)) return intrinsic_none;
+
+    static const struct
+    {
+        const char      *prefix;
+        intrinsic_kind_t kind;
+
+    } table[] =
+    {
+        { "llvm.stacksave",    intrinsic_stacksave },
+        { "llvm.stackrestore", intrinsic_stackrestore },
+        { "llvm.memcpy.",      intrinsic_memcpy },
+        { "llvm.memmove.",     intrinsic_memmove },
+        { "llvm.memset.",      intrinsic_memset },
+        { "llvm.lifetime.",    intrinsic_nop },
+        { "llvm.dbg.",         intrinsic_nop },
+        { "llvm.assume",       intrinsic_nop },
+    };
+
+    size_t len;
+
+    auto name = LLVMGetValueName2(fun, &len);
+
+    for (auto &it : table)
+    {
+        if (std::strncmp(name, it.prefix, std::strlen(it.prefix)) == 0)  return it.kind;
+    }
+
+    return intrinsic_unknown;
+}
+
+
+//---------------------------------------------------------------------
+//- Values: integers (zero-extended) and pointers, all in uint64_t
+//---------------------------------------------------------------------
+inline uint64_t
+mask(uint64_t v, unsigned w)
+{
+    return  (w >= 64 ? v : v & ((uint64_t(1) << w) - 1));
+}
+
+inline int64_t
+sext(uint64_t v, unsigned w)
+{
+    if (w >= 64)  return int64_t(v);
+
+    unsigned s = 64 - w;
+
+    return  int64_t(v << s) >> s;
+}
+
+inline unsigned
+width(LLVMTypeRef t)
+{
+    return  (LLVMGetTypeKind(t) == LLVMIntegerTypeKind ? LLVMGetIntTypeWidth(t) : 64);
+}
+
+//---------------------------------------------------------------------
+bool
+scalar_type_ok(LLVMTypeRef t, bool void_ok = false)
+{
+    switch(LLVMGetTypeKind(t))
+    {
+    case LLVMVoidTypeKind:
+        return void_ok;
+
+    case LLVMIntegerTypeKind:
+        switch(LLVMGetIntTypeWidth(t))
+        {
+        case 1: case 8: case 16: case 32: case 64:
+            return true;
+
+        default:
+            return false;
+        }
+
+    case LLVMPointerTypeKind:
+        return  (LLVMGetPointerAddressSpace(t) == 0);
+
+    default:
+        return false;
+    }
+}
+
+//---------------------------------------------------------------------
+bool
+value_ok(LLVMValueRef v)
+{
+    if (!scalar_type_ok(LLVMTypeOf(v)))  return false;
+
+    if (LLVMIsAInstruction(v)  ||  LLVMIsAArgument(v))  return true;
+
+    if (LLVMIsAConstantInt(v))          return true;
+    if (LLVMIsAConstantPointerNull(v))  return true;
+    if (LLVMIsAUndefValue(v))           return true;        //- Poison too
+
+    if (LLVMIsAFunction(v))
+    {
+        return  (LLVMIsDeclaration(v)  &&  get_intrinsic_kind(v) == intrinsic_none);
+    }
+
+    if (LLVMIsAGlobalVariable(v))  return true;
+
+    if (LLVMIsAConstantExpr(v))
+    {
+        switch(LLVMGetConstOpcode(v))
+        {
+        case LLVMGetElementPtr:
+            if (!LLVMTypeIsSized(LLVMGetGEPSourceElementType(v)))  return false;
+            break;
+
+        case LLVMAdd: case LLVMSub: case LLVMMul:
+        case LLVMAnd: case LLVMOr:  case LLVMXor:
+        case LLVMShl: case LLVMLShr: case LLVMAShr:
+        case LLVMTrunc: case LLVMZExt: case LLVMSExt:
+        case LLVMPtrToInt: case LLVMIntToPtr: case LLVMBitCast:
+        case LLVMICmp: case LLVMSelect:
+            break;
+
+        default:
+            return false;
+        }
+
+        for (int i=0; i<LLVMGetNumOperands(v); ++i)
+        {
+            if (!value_ok(LLVMGetOperand(v, i)))  return false;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------
+bool
+initializer_ok(LLVMValueRef c)
+{
+    auto t = LLVMTypeOf(c);
+
+    if (LLVMIsAConstantAggregateZero(c)  ||  LLVMIsAUndefValue(c))
+    {
+        return  LLVMTypeIsSized(t);
+    }
+
+    if (LLVMIsAConstantDataSequential(c))
+    {
+        return  (LLVMGetTypeKind(t) == LLVMArrayTypeKind  &&
+                 LLVMGetTypeKind(LLVMGetElementType(t)) == LLVMIntegerTypeKind  &&
+                 scalar_type_ok(LLVMGetElementType(t)));
+    }
+
+    if (LLVMIsAConstantArray(c)  ||  LLVMIsAConstantStruct(c))
+    {
+        for (int i=0; i<LLVMGetNumOperands(c); ++i)
+        {
+            if (!initializer_ok(LLVMGetOperand(c, i)))  return false;
+        }
+
+        return true;
+    }
+
+    return  value_ok(c);
+}
+
+//---------------------------------------------------------------------
+bool
+call_ok(LLVMValueRef inst)
+{
+    auto callee = LLVMGetCalledValue(inst);
+
+    if (LLVMIsAInlineAsm(callee))  return false;
+
+    if (LLVMGetInstructionCallConv(inst) != LLVMCCallConv)  return false;
+
+    unsigned n = LLVMGetNumArgOperands(inst);
+
+    if (LLVMIsAFunction(callee))
+    {
+        switch(get_intrinsic_kind(callee))
+        {
+        case intrinsic_none:
+            break;
+
+        case intrinsic_unknown:
+            return false;
+
+        case intrinsic_nop:
+            return true;                //- Arguments don't matter...
+
+        default:
+            for (unsigned i=0; i<n; ++i)
+            {
+                if (!value_ok(LLVMGetOperand(inst, i)))  return false;
+            }
+
+            return true;
+        }
+    }
+
+    if (!value_ok(callee))  return false;
+
+    //- Callees are called through uint64_t (*)(uint64_t...) - see
+    //- interp_t::call. That's only sound if every parameter and the
+    //- result are integers/pointers (one register or stack slot each)
+    //- and the callee is not variadic. Else - native code...
+
+    auto ft = LLVMGetCalledFunctionType(inst);
+
+    if (LLVMIsFunctionVarArg(ft))  return false;
+
+    if (n > max_call_args  ||  n != LLVMCountParamTypes(ft))  return false;
+
+    if (!scalar_type_ok(LLVMGetReturnType(ft), true))  return false;
+
+    {   LLVMTypeRef params[max_call_args];
+
+        LLVMGetParamTypes(ft, params);
+
+        for (unsigned i=0; i<n; ++i)
+        {
+            if (!scalar_type_ok(params[i]))  return false;
+        }
+    }
+
+    if (LLVMIsAFunction(callee)  &&  LLVMGlobalGetValueType(callee) != ft)  return false;    //- E.g. variadic, called as not
+
+    static const char *bad_attrs[] =
+    {
+        "byval", "sret", "inalloca", "preallocated", "nest",
+        "swiftself", "swifterror", "swiftasync",
+    };
+
+    for (unsigned i=0; i<n; ++i)
+    {
+        if (!value_ok(LLVMGetOperand(inst, i)))  return false;
+
+        for (auto name : bad_attrs)
+        {
+            auto kind = LLVMGetEnumAttributeKindForName(name, std::strlen(name));
+
+            if (LLVMGetCallSiteEnumAttribute(inst, i+1, kind))  return false;
+
+            if (LLVMIsAFunction(callee)  &&  LLVMGetEnumAttributeAtIndex(callee, i+1, kind))  return false;
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------
+voidc_interp_check_t
+check_instruction(LLVMValueRef inst, const std::unordered_map<LLVMBasicBlockRef, size_t> &index, size_t current)
+{
+    if (!scalar_type_ok(LLVMTypeOf(inst), true))  return voidc_interp_unsupported;
+
+    auto op = LLVMGetInstructionOpcode(inst);
+
+    switch(op)
+    {
+    case LLVMRet:
+        return  (LLVMGetNumOperands(inst) == 0 ? voidc_interp_ok : voidc_interp_unsupported);
+
+    case LLVMBr:
+    case LLVMSwitch:
+        {   for (unsigned i=0; i<LLVMGetNumSuccessors(inst); ++i)
+            {
+                auto it = index.find(LLVMGetSuccessor(inst, i));
+
+                if (it == index.end())  return voidc_interp_unsupported;       //- Not verified yet!
+
+                if (it->second <= current)  return voidc_interp_loop;
+            }
+
+            if (op == LLVMBr)
+            {
+                if (LLVMIsConditional(inst)  &&  !value_ok(LLVMGetCondition(inst)))  return voidc_interp_unsupported;
+            }
+            else
+            {
+                //- Condition, default, (value, destination)...
+
+                for (int i=0; i<LLVMGetNumOperands(inst); i+=2)
+                {
+                    if (!value_ok(LLVMGetOperand(inst, i)))  return voidc_interp_unsupported;
+                }
+            }
+
+            return voidc_interp_ok;
+        }
+
+    case LLVMAlloca:
+        if (!LLVMTypeIsSized(LLVMGetAllocatedType(inst)))  return voidc_interp_unsupported;
+        break;
+
+    case LLVMLoad:
+    case LLVMStore:
+        if (LLVMGetOrdering(inst) != LLVMAtomicOrderingNotAtomic)  return voidc_interp_unsupported;
+        break;
+
+    case LLVMGetElementPtr:
+        if (!LLVMTypeIsSized(LLVMGetGEPSourceElementType(inst)))  return voidc_interp_unsupported;
+        break;
+
+    case LLVMCall:
+        return  (call_ok(inst) ? voidc_interp_ok : voidc_interp_unsupported);
+
+    case LLVMAdd: case LLVMSub: case LLVMMul:
+    case LLVMUDiv: case LLVMSDiv: case LLVMURem: case LLVMSRem:
+    case LLVMAnd: case LLVMOr:  case LLVMXor:
+    case LLVMShl: case LLVMLShr: case LLVMAShr:
+    case LLVMTrunc: case LLVMZExt: case LLVMSExt:
+    case LLVMPtrToInt: case LLVMIntToPtr: case LLVMBitCast:
+    case LLVMICmp: case LLVMSelect: case LLVMFreeze:
+    case LLVMPHI:
+        break;
+
+    default:
+        return voidc_interp_unsupported;
+    }
+
+    for (int i=0; i<LLVMGetNumOperands(inst); ++i)
+    {
+        if (!value_ok(LLVMGetOperand(inst, i)))  return voidc_interp_unsupported;
+    }
+
+    return voidc_interp_ok;
+}
+
+
+//---------------------------------------------------------------------
+//- Interpreter itself
+//---------------------------------------------------------------------
+class interp_t
+{
+public:
+    interp_t(LLVMTargetDataRef dl, voidc_interp_resolve_t resolve, void *aux)
+      : data_layout(dl), resolve_fun(resolve), resolve_aux(aux)
+    {}
+
+public:
+    void run(LLVMModuleRef module, LLVMValueRef fun);
+
+private:
+    char *allocate(size_t size, size_t align);          //- Zero-filled
+
+    void *resolve(LLVMValueRef v);
+
+    uint64_t eval(LLVMValueRef v);
+    uint64_t eval_op(LLVMOpcode op, LLVMValueRef v);
+    uint64_t eval_gep(LLVMValueRef v);
+    uint64_t eval_icmp(LLVMValueRef v);
+
+    uint64_t load(const void *p, LLVMTypeRef t);
+    void     store(void *p, LLVMTypeRef t, uint64_t val);
+
+    void store_initializer(char *p, LLVMValueRef c);
+
+    uint64_t call(LLVMValueRef inst);
+    uint64_t call_intrinsic(intrinsic_kind_t kind, LLVMValueRef inst);
+
+    LLVMBasicBlockRef exec_block(LLVMBasicBlockRef bb, LLVMBasicBlockRef prev);
+
+private:
+    const LLVMTargetDataRef data_layout;
+
+    const voidc_interp_resolve_t resolve_fun;
+    void * const                 resolve_aux;
+
+    std::vector<std::unique_ptr<char[]>> memory;        //- Globals, then allocas
+
+    std::unordered_map<LLVMValueRef, uint64_t> values;
+    std::unordered_map<LLVMValueRef, void *>   symbols;
+};
+
+//---------------------------------------------------------------------
+char *
+interp_t::allocate(size_t size, size_t align)
+{
+    if (align == 0)  align = 1;
+
+    auto block = std::make_unique<char[]>(size + align);
+
+    auto p = reinterpret_cast<uintptr_t>(block.get());
+
+    p = (p + align - 1) & ~uintptr_t(align - 1);
+
+    memory.push_back(std::move(block));
+
+    return  reinterpret_cast<char *>(p);
+}
+
+//---------------------------------------------------------------------
+void *
+interp_t::resolve(LLVMValueRef v)
+{
+    auto it = symbols.find(v);
+
+    if (it != symbols.end())  return it->second;
+
+    size_t len;
+
+    auto name = LLVMGetValueName2(v, &len);
+
+    void *p = resolve_fun(resolve_aux, name);
+
+    if (!p)
+    {
+        printf("\nSymbol not found: %s\n", name);
+
+        abort();                //- Sic !!!
+    }
+
+    symbols[v] = p;
+
+    return p;
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::eval(LLVMValueRef v)
+{
+    if (LLVMIsAInstruction(v)  ||  LLVMIsAArgument(v))  return values[v];
+
+    if (LLVMIsAConstantInt(v))  return mask(LLVMConstIntGetZExtValue(v), width(LLVMTypeOf(v)));
+
+    if (LLVMIsAConstantPointerNull(v)  ||  LLVMIsAUndefValue(v))  return 0;
+
+    if (LLVMIsAGlobalValue(v))  return uint64_t(resolve(v));
+
+    if (LLVMIsAConstantExpr(v))  return eval_op(LLVMGetConstOpcode(v), v);
+
+    abort();                    //- Checked before...
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::eval_op(LLVMOpcode op, LLVMValueRef v)
+{
+    auto arg = [this, v](int i) { return eval(LLVMGetOperand(v, i)); };
+
+    unsigned w = width(LLVMTypeOf(v));
+
+    auto div_check = [](uint64_t d)
+    {
+        if (d)  return;
+
+        printf("\nInteger division by zero\n");
+
+        abort();                //- Sic !!!
+    };
+
+    switch(op)
+    {
+    case LLVMAdd:   return mask(arg(0) + arg(1), w);
+    case LLVMSub:   return mask(arg(0) - arg(1), w);
+    case LLVMMul:   return mask(arg(0) * arg(1), w);
+    case LLVMAnd:   return arg(0) & arg(1);
+    case LLVMOr:    return arg(0) | arg(1);
+    case LLVMXor:   return arg(0) ^ arg(1);
+
+    case LLVMUDiv:
+    case LLVMURem:
+        {   auto a = arg(0);
+            auto b = arg(1);
+
+            div_check(b);
+
+            return  (op == LLVMUDiv ? a / b : a % b);
+        }
+
+    case LLVMSDiv:
+    case LLVMSRem:
+        {   auto a = sext(arg(0), w);
+            auto b = sext(arg(1), w);
+
+            div_check(b);
+
+            if (b == -1)  return  (op == LLVMSDiv ? mask(0 - uint64_t(a), w) : 0);     //- No overflow!
+
+            return  mask(uint64_t(op == LLVMSDiv ? a / b : a % b), w);
+        }
+
+    case LLVMShl:
+    case LLVMLShr:
+    case LLVMAShr:
+        {   auto a = arg(0);
+            auto s = arg(1);
+
+            if (s >= w)  return 0;      //- Poison, actually...
+
+            if (op == LLVMShl)  return mask(a << s, w);
+            if (op == LLVMLShr) return a >> s;
+
+            return  mask(uint64_t(sext(a, w) >> s), w);
+        }
+
+    case LLVMTrunc:
+    case LLVMPtrToInt:
+        return  mask(arg(0), w);
+
+    case LLVMSExt:
+        return  mask(uint64_t(sext(arg(0), width(LLVMTypeOf(LLVMGetOperand(v, 0))))), w);
+
+    case LLVMZExt:
+    case LLVMIntToPtr:
+    case LLVMBitCast:
+    case LLVMFreeze:
+        return  arg(0);
+
+    case LLVMSelect:
+        return  (arg(0) ? arg(1) : arg(2));
+
+    case LLVMICmp:
+        return  eval_icmp(v);
+
+    case LLVMGetElementPtr:
+        return  eval_gep(v);
+
+    default:
+        abort();                //- Checked before...
+    }
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::eval_gep(LLVMValueRef v)
+{
+    uint64_t addr = eval(LLVMGetOperand(v, 0));
+
+    auto t = LLVMGetGEPSourceElementType(v);
+
+    int n = LLVMGetNumOperands(v);
+
+    for (int i=1; i<n; ++i)
+    {
+        auto idx_v = LLVMGetOperand(v, i);
+
+        int64_t idx = sext(eval(idx_v), width(LLVMTypeOf(idx_v)));
+
+        if (i == 1)
+        {
+            addr += idx * LLVMABISizeOfType(data_layout, t);
+        }
+        else if (LLVMGetTypeKind(t) == LLVMStructTypeKind)
+        {
+            addr += LLVMOffsetOfElement(data_layout, t, unsigned(idx));
+
+            t = LLVMStructGetTypeAtIndex(t, unsigned(idx));
+        }
+        else
+        {
+            t = LLVMGetElementType(t);
+
+            addr += idx * LLVMABISizeOfType(data_layout, t);
+        }
+    }
+
+    return addr;
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::eval_icmp(LLVMValueRef v)
+{
+    auto op0 = LLVMGetOperand(v, 0);
+
+    unsigned w = width(LLVMTypeOf(op0));
+
+    uint64_t a = eval(op0);
+    uint64_t b = eval(LLVMGetOperand(v, 1));
+
+    int64_t sa = sext(a, w);
+    int64_t sb = sext(b, w);
+
+    switch(LLVMGetICmpPredicate(v))
+    {
+    case LLVMIntEQ:     return a == b;
+    case LLVMIntNE:     return a != b;
+    case LLVMIntUGT:    return a >  b;
+    case LLVMIntUGE:    return a >= b;
+    case LLVMIntULT:    return a <  b;
+    case LLVMIntULE:    return a <= b;
+    case LLVMIntSGT:    return sa >  sb;
+    case LLVMIntSGE:    return sa >= sb;
+    case LLVMIntSLT:    return sa <  sb;
+    case LLVMIntSLE:    return sa <= sb;
+    }
+
+    abort();
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::load(const void *p, LLVMTypeRef t)
+{
+    switch(width(t))
+    {
+    case 1:  { uint8_t  r; std::memcpy(&r, p, 1); return r & 1; }
+    case 8:  { uint8_t  r; std::memcpy(&r, p, 1); return r; }
+    case 16: { uint16_t r; std::memcpy(&r, p, 2); return r; }
+    case 32: { uint32_t r; std::memcpy(&r, p, 4); return r; }
+    default: { uint64_t r; std::memcpy(&r, p, 8); return r; }
+    }
+}
+
+void
+interp_t::store(void *p, LLVMTypeRef t, uint64_t val)
+{
+    switch(width(t))
+    {
+    case 1:
+    case 8:  { uint8_t  r = uint8_t(val);  std::memcpy(p, &r, 1); break; }
+    case 16: { uint16_t r = uint16_t(val); std::memcpy(p, &r, 2); break; }
+    case 32: { uint32_t r = uint32_t(val); std::memcpy(p, &r, 4); break; }
+    default: {                             std::memcpy(p, &val, 8); break; }
+    }
+}
+
+//---------------------------------------------------------------------
+void
+interp_t::store_initializer(char *p, LLVMValueRef c)
+{
+    if (LLVMIsAConstantAggregateZero(c)  ||  LLVMIsAUndefValue(c))  return;     //- Zero-filled already
+
+    auto t = LLVMTypeOf(c);
+
+    if (LLVMIsAConstantDataSequential(c))
+    {
+        if (LLVMIsConstantString(c))
+        {
+            size_t len;
+
+            auto str = LLVMGetAsString(c, &len);
+
+            std::memcpy(p, str, len);
+
+            return;
+        }
+
+        auto et = LLVMGetElementType(t);
+
+        auto sz = LLVMABISizeOfType(data_layout, et);
+
+        for (unsigned i=0; i<LLVMGetArrayLength(t); ++i)
+        {
+            store(p + i*sz, et, eval(LLVMGetElementAsConstant(c, i)));
+        }
+
+        return;
+    }
+
+    if (LLVMIsAConstantArray(c))
+    {
+        auto sz = LLVMABISizeOfType(data_layout, LLVMGetElementType(t));
+
+        for (int i=0; i<LLVMGetNumOperands(c); ++i)
+        {
+            store_initializer(p + i*sz, LLVMGetOperand(c, i));
+        }
+
+        return;
+    }
+
+    if (LLVMIsAConstantStruct(c))
+    {
+        for (int i=0; i<LLVMGetNumOperands(c); ++i)
+        {
+            store_initializer(p + LLVMOffsetOfElement(data_layout, t, i), LLVMGetOperand(c, i));
+        }
+
+        return;
+    }
+
+    store(p, t, eval(c));
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::call(LLVMValueRef inst)
+{
+    auto callee = LLVMGetCalledValue(inst);
+
+    if (LLVMIsAFunction(callee))
+    {
+        auto kind = get_intrinsic_kind(callee);
+
+        if (kind != intrinsic_none)  return call_intrinsic(kind, inst);
+    }
+
+    static const unsigned signext_kind = LLVMGetEnumAttributeKindForName("signext", 7);
+
+    auto has_signext = [inst, callee](unsigned idx)
+    {
+        if (LLVMGetCallSiteEnumAttribute(inst, idx, signext_kind))  return true;
+
+        return  (LLVMIsAFunction(callee)  &&  LLVMGetEnumAttributeAtIndex(callee, idx, signext_kind));
+    };
+
+    unsigned n = LLVMGetNumArgOperands(inst);
+
+    uint64_t a[max_call_args] = {};
+
+    for (unsigned i=0; i<n; ++i)
+    {
+        auto arg = LLVMGetOperand(inst, i);
+
+        a[i] = eval(arg);
+
+        unsigned w = width(LLVMTypeOf(arg));
+
+        if (w < 64  &&  has_signext(i+1))  a[i] = uint64_t(sext(a[i], w));
+    }
+
+    //- All arguments are integers/pointers, so every one of them
+    //- takes exactly one register (or stack slot)...
+
+    void *f = reinterpret_cast<void *>(eval(callee));
+
+    uint64_t r = 0;
+
+    switch(n)
+    {
+    case 0: r = ((uint64_t (*)())f)(); break;
+    case 1: r = ((uint64_t (*)(uint64_t))f)(a[0]); break;
+    case 2: r = ((uint64_t (*)(uint64_t, uint64_t))f)(a[0], a[1]); break;
+    case 3: r = ((uint64_t (*)(uint64_t, uint64_t, uint64_t))f)(a[0], a[1], a[2]); break;
+    case 4: r = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t))f)(a[0], a[1], a[2], a[3]); break;
+
+    case 5: r = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t,
+                               uint64_t))f)(a[0], a[1], a[2], a[3], a[4]); break;
+    case 6: r = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t,
+                               uint64_t, uint64_t))f)(a[0], a[1], a[2], a[3], a[4], a[5]); break;
+    case 7: r = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t,
+                               uint64_t, uint64_t, uint64_t))f)(a[0], a[1], a[2], a[3], a[4], a[5], a[6]); break;
+    case 8: r = ((uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t,
+                               uint64_t, uint64_t, uint64_t, uint64_t))f)(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]); break;
+
+    default:
+        abort();                //- Checked before...
+    }
+
+    auto rt = LLVMGetReturnType(LLVMGetCalledFunctionType(inst));
+
+    if (LLVMGetTypeKind(rt) == LLVMVoidTypeKind)  return 0;
+
+    return  mask(r, width(rt));
+}
+
+//---------------------------------------------------------------------
+uint64_t
+interp_t::call_intrinsic(intrinsic_kind_t kind, LLVMValueRef inst)
+{
+    auto arg = [this, inst](int i) { return eval(LLVMGetOperand(inst, i)); };
+
+    switch(kind)
+    {
+    case intrinsic_stacksave:
+        return  memory.size();
+
+    case intrinsic_stackrestore:
+        {   size_t sz = arg(0);
+
+            if (sz < memory.size())  memory.resize(sz);
+
+            return 0;
+        }
+
+    case intrinsic_memcpy:
+        std::memcpy((void *)arg(0), (const void *)arg(1), arg(2));
+        return 0;
+
+    case intrinsic_memmove:
+        std::memmove((void *)arg(0), (const void *)arg(1), arg(2));
+        return 0;
+
+    case intrinsic_memset:
+        std::memset((void *)arg(0), int(arg(1)), arg(2));
+        return 0;
+
+    default:
+        return 0;
+    }
+}
+
+//---------------------------------------------------------------------
+LLVMBasicBlockRef
+interp_t::exec_block(LLVMBasicBlockRef bb, LLVMBasicBlockRef prev)
+{
+    auto inst = LLVMGetFirstInstruction(bb);
+
+    //- Phi nodes - "in parallel"...
+
+    std::vector<std::pair<LLVMValueRef, uint64_t>> phis;
+
+    for (; LLVMGetInstructionOpcode(inst) == LLVMPHI; inst = LLVMGetNextInstruction(inst))
+    {
+        for (unsigned i=0; i<LLVMCountIncoming(inst); ++i)
+        {
+            if (LLVMGetIncomingBlock(inst, i) == prev)
+            {
+                phis.push_back({inst, eval(LLVMGetIncomingValue(inst, i))});
+
+                break;
+            }
+        }
+    }
+
+    for (auto &it : phis)  values[it.first] = it.second;
+
+    //- The rest...
+
+    for (; inst; inst = LLVMGetNextInstruction(inst))
+    {
+        auto op = LLVMGetInstructionOpcode(inst);
+
+        switch(op)
+        {
+        case LLVMRet:
+            return nullptr;
+
+        case LLVMBr:
+            if (LLVMIsConditional(inst))
+            {
+                return  LLVMGetSuccessor(inst, (eval(LLVMGetCondition(inst)) ? 0 : 1));
+            }
+
+            return  LLVMGetSuccessor(inst, 0);
+
+        case LLVMSwitch:
+            {   auto c = eval(LLVMGetOperand(inst, 0));
+
+                for (int i=2; i<LLVMGetNumOperands(inst); i+=2)
+                {
+                    if (eval(LLVMGetOperand(inst, i)) == c)  return LLVMValueAsBasicBlock(LLVMGetOperand(inst, i+1));
+                }
+
+                return  LLVMGetSwitchDefaultDest(inst);
+            }
+
+        case LLVMAlloca:
+            {   auto t = LLVMGetAllocatedType(inst);
+
+                size_t sz = LLVMABISizeOfType(data_layout, t) * eval(LLVMGetOperand(inst, 0));
+
+                size_t al = std::max<size_t>(LLVMGetAlignment(inst), LLVMABIAlignmentOfType(data_layout, t));
+
+                values[inst] = uint64_t(allocate(sz, al));
+
+                break;
+            }
+
+        case LLVMLoad:
+            values[inst] = load((const void *)eval(LLVMGetOperand(inst, 0)), LLVMTypeOf(inst));
+            break;
+
+        case LLVMStore:
+            {   auto v = LLVMGetOperand(inst, 0);
+
+                store((void *)eval(LLVMGetOperand(inst, 1)), LLVMTypeOf(v), eval(v));
+
+                break;
+            }
+
+        case LLVMCall:
+            {   auto r = call(inst);
+
+                if (LLVMGetTypeKind(LLVMTypeOf(inst)) != LLVMVoidTypeKind)  values[inst] = r;
+
+                break;
+            }
+
+        default:
+            values[inst] = eval_op(op, inst);
+            break;
+        }
+    }
+
+    abort();                    //- No terminator ?!?
+}
+
+//---------------------------------------------------------------------
+void
+interp_t::run(LLVMModuleRef module, LLVMValueRef fun)
+{
+    //- Private globals: addresses first, then initializers...
+
+    for (auto g = LLVMGetFirstGlobal(module); g; g = LLVMGetNextGlobal(g))
+    {
+        if (LLVMIsDeclaration(g))  continue;
+
+        auto t = LLVMGlobalGetValueType(g);
+
+        size_t al = std::max<size_t>(LLVMGetAlignment(g), LLVMABIAlignmentOfType(data_layout, t));
+
+        symbols[g] = allocate(LLVMABISizeOfType(data_layout, t), al);
+    }
+
+    for (auto g = LLVMGetFirstGlobal(module); g; g = LLVMGetNextGlobal(g))
+    {
+        if (LLVMIsDeclaration(g))  continue;
+
+        store_initializer((char *)symbols[g], LLVMGetInitializer(g));
+    }
+
+    //- External symbols - before any side effects, like linker does...
+
+    for (auto g = LLVMGetFirstGlobal(module); g; g = LLVMGetNextGlobal(g))
+    {
+        if (LLVMIsDeclaration(g)  &&  LLVMGetFirstUse(g))  resolve(g);
+    }
+
+    for (auto f = LLVMGetFirstFunction(module); f; f = LLVMGetNextFunction(f))
+    {
+        if (f == fun  ||  !LLVMGetFirstUse(f))  continue;
+
+        if (get_intrinsic_kind(f) == intrinsic_none)  resolve(f);
+    }
+
+    //- Go!
+
+    LLVMBasicBlockRef prev = nullptr;
+
+    for (auto bb = LLVMGetEntryBasicBlock(fun); bb; )
+    {
+        auto next = exec_block(bb, prev);
+
+        prev = bb;
+        bb   = next;
+    }
+}
+
+
+}   //- namespace
+
+
+//---------------------------------------------------------------------
+voidc_interp_check_t
+voidc_interp_check_module(LLVMModuleRef module, LLVMValueRef fun)
+{
+    if (sizeof(void *) != sizeof(uint64_t))  return voidc_interp_unsupported;
+
+    if (LLVMCountParams(fun) != 0)  return voidc_interp_unsupported;
+
+    if (LLVMGetFirstGlobalAlias(module)  ||  LLVMGetFirstGlobalIFunc(module))  return voidc_interp_unsupported;
+
+    for (auto f = LLVMGetFirstFunction(module); f; f = LLVMGetNextFunction(f))
+    {
+        if (f == fun)  continue;
+
+        if (!LLVMIsDeclaration(f))  return voidc_interp_unsupported;    //- Helpers, init/term, ...
+
+        if (get_intrinsic_kind(f) == intrinsic_unknown)  return voidc_interp_unsupported;
+    }
+
+    for (auto g = LLVMGetFirstGlobal(module); g; g = LLVMGetNextGlobal(g))
+    {
+        if (LLVMIsThreadLocal(g))  return voidc_interp_unsupported;
+
+        if (LLVMIsDeclaration(g))  continue;
+
+        switch(LLVMGetLinkage(g))
+        {
+        case LLVMPrivateLinkage:
+        case LLVMInternalLinkage:
+            break;
+
+        default:
+            return voidc_interp_unsupported;
+        }
+
+        if (!initializer_ok(LLVMGetInitializer(g)))  return voidc_interp_unsupported;
+    }
+
+    //- Blocks: forward branches only
+
+    std::unordered_map<LLVMBasicBlockRef, size_t> index;
+
+    for (auto bb = LLVMGetFirstBasicBlock(fun); bb; bb = LLVMGetNextBasicBlock(bb))
+    {
+        index.insert({bb, index.size()});
+    }
+
+    auto ret = voidc_interp_ok;
+
+    for (auto bb = LLVMGetFirstBasicBlock(fun); bb; bb = LLVMGetNextBasicBlock(bb))
+    {
+        auto current = index[bb];
+
+        for (auto inst = LLVMGetFirstInstruction(bb); inst; inst = LLVMGetNextInstruction(inst))
+        {
+            switch(check_instruction(inst, index, current))
+            {
+            case voidc_interp_ok:
+                break;
+
+            case voidc_interp_loop:
+                return voidc_interp_loop;
+
+            case voidc_interp_unsupported:
+                ret = voidc_interp_unsupported;
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+//---------------------------------------------------------------------
+void
+voidc_interp_run_function(LLVMModuleRef module, LLVMValueRef fun,
+                          LLVMTargetDataRef data_layout,
+                          voidc_interp_resolve_t resolve, void *aux)
+{
+    interp_t interp(data_layout, resolve, aux);
+
+    interp.run(module, fun);
+}
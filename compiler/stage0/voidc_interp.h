@@ -0,0 +1,41 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_INTERP_H
+#define VOIDC_INTERP_H
+
+#include <llvm-c/Core.h>
+#include <llvm-c/Target.h>
+
+
+//---------------------------------------------------------------------
+//- Unit action interpreter
+//---------------------------------------------------------------------
+//- Most unit actions are executed exactly once and consist of a few
+//- calls with constant arguments. For them, codegen + linking costs
+//- much more than the action itself...
+//- Supported: straight-line code (forward branches only), integers
+//- up to 64 bits, pointers, private globals, direct/indirect calls
+//- with up to 8 integer/pointer arguments (no varargs).
+//- Everything else goes to native codegen as before.
+//---------------------------------------------------------------------
+enum voidc_interp_check_t
+{
+    voidc_interp_ok,
+    voidc_interp_loop,              //- Backward branch found
+    voidc_interp_unsupported,       //- Instruction, type, global, ...
+};
+
+typedef void *(*voidc_interp_resolve_t)(void *aux, const char *name);
+
+
+//---------------------------------------------------------------------
+voidc_interp_check_t voidc_interp_check_module(LLVMModuleRef module, LLVMValueRef fun);
+
+void voidc_interp_run_function(LLVMModuleRef module, LLVMValueRef fun,
+                               LLVMTargetDataRef data_layout,
+                               voidc_interp_resolve_t resolve, void *aux);
+
+
+#endif      //- VOIDC_INTERP_H
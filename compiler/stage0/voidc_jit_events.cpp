@@ -0,0 +1,279 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_jit_events.h"
+
+#include <string>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cinttypes>
+
+#ifndef _WIN32
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+//---------------------------------------------------------------------
+namespace
+{
+
+int jit_events_flags = 0;
+
+std::mutex jit_events_mutex;
+
+#ifndef _WIN32
+
+//---------------------------------------------------------------------
+//- perf map
+//---------------------------------------------------------------------
+std::FILE *perf_map = nullptr;
+
+
+//---------------------------------------------------------------------
+//- jitdump (see tools/perf/Documentation/jitdump-specification.txt)
+//---------------------------------------------------------------------
+struct jitdump_header_t
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+};
+
+struct jitdump_record_t
+{
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+};
+
+struct jitdump_code_load_t
+{
+    jitdump_record_t record;
+
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+
+    //- Then: name (zero terminated), code bytes...
+};
+
+constexpr uint32_t jitdump_magic     = 0x4A695444;      //- "JiTD"
+constexpr uint32_t jitdump_code_load = 0;
+
+#if defined(__x86_64__)
+constexpr uint32_t jitdump_elf_mach = 62;               //- EM_X86_64
+#elif defined(__aarch64__)
+constexpr uint32_t jitdump_elf_mach = 183;              //- EM_AARCH64
+#elif defined(__i386__)
+constexpr uint32_t jitdump_elf_mach = 3;                //- EM_386
+#elif defined(__arm__)
+constexpr uint32_t jitdump_elf_mach = 40;               //- EM_ARM
+#elif defined(__riscv)
+constexpr uint32_t jitdump_elf_mach = 243;              //- EM_RISCV
+#else
+constexpr uint32_t jitdump_elf_mach = 0;
+#endif
+
+std::FILE *jitdump = nullptr;
+
+void  *jitdump_marker = nullptr;        //- perf record sees jitdump by this mmap...
+size_t jitdump_marker_size = 0;
+
+uint64_t jitdump_code_index = 0;
+
+//---------------------------------------------------------------------
+uint64_t
+timestamp(void)             //- perf record -k mono
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return  uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+//---------------------------------------------------------------------
+void
+jitdump_open(void)
+{
+    std::string path = ".";
+
+    if (auto dir = std::getenv("JITDUMPDIR"))  path = dir;
+
+    path += "/jit-" + std::to_string(getpid()) + ".dump";
+
+    int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0666);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "Can't open %s\n", path.c_str());
+
+        return;
+    }
+
+    jitdump_marker_size = sysconf(_SC_PAGESIZE);
+
+    jitdump_marker = mmap(nullptr, jitdump_marker_size, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+
+    if (jitdump_marker == MAP_FAILED)
+    {
+        fprintf(stderr, "Can't mmap %s\n", path.c_str());
+
+        jitdump_marker = nullptr;
+
+        close(fd);
+
+        return;
+    }
+
+    jitdump = fdopen(fd, "wb");
+
+    jitdump_header_t header =
+    {
+        jitdump_magic,
+        1,                          //- Version
+        sizeof(jitdump_header_t),
+        jitdump_elf_mach,
+        0,
+        uint32_t(getpid()),
+        timestamp(),
+        0
+    };
+
+    std::fwrite(&header, sizeof(header), 1, jitdump);
+
+    std::fflush(jitdump);
+}
+
+void
+jitdump_close(void)
+{
+    if (jitdump_marker)  munmap(jitdump_marker, jitdump_marker_size);
+
+    jitdump_marker = nullptr;
+
+    if (jitdump)  std::fclose(jitdump);
+
+    jitdump = nullptr;
+}
+
+#endif  //- _WIN32
+
+}   //- namespace
+
+
+//---------------------------------------------------------------------
+void
+voidc_jit_events_initialize(int flags)
+{
+    jit_events_flags = flags;
+
+#ifndef _WIN32
+
+    if (flags & voidc_jit_events_perf_map)
+    {
+        std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+
+        perf_map = std::fopen(path.c_str(), "w");
+
+        if (!perf_map)  fprintf(stderr, "Can't open %s\n", path.c_str());
+    }
+
+    if (flags & voidc_jit_events_jitdump)  jitdump_open();
+
+#endif
+}
+
+void
+voidc_jit_events_terminate(void)
+{
+#ifndef _WIN32
+
+    if (perf_map)  std::fclose(perf_map);
+
+    perf_map = nullptr;
+
+    jitdump_close();
+
+#endif
+
+    jit_events_flags = 0;
+}
+
+//---------------------------------------------------------------------
+int
+voidc_jit_events_flags(void)
+{
+    return  jit_events_flags;
+}
+
+bool
+voidc_jit_events_code_enabled(void)
+{
+#ifndef _WIN32
+
+    return  (perf_map  ||  jitdump);
+
+#else
+
+    return false;
+
+#endif
+}
+
+//---------------------------------------------------------------------
+void
+voidc_jit_events_code_load(const char *name, uint64_t addr, uint64_t size)
+{
+#ifndef _WIN32
+
+    std::lock_guard<std::mutex> lock(jit_events_mutex);
+
+    if (perf_map)
+    {
+        fprintf(perf_map, "%" PRIx64 " %" PRIx64 " %s\n", addr, size, name);
+
+        std::fflush(perf_map);          //- Process may be killed...
+    }
+
+    if (jitdump)
+    {
+        size_t name_size = std::strlen(name) + 1;
+
+        jitdump_code_load_t rec;
+
+        rec.record.id         = jitdump_code_load;
+        rec.record.total_size = uint32_t(sizeof(rec) + name_size + size);
+        rec.record.timestamp  = timestamp();
+
+        rec.pid        = uint32_t(getpid());
+        rec.tid        = uint32_t(syscall(SYS_gettid));
+        rec.vma        = addr;
+        rec.code_addr  = addr;
+        rec.code_size  = size;
+        rec.code_index = jitdump_code_index++;
+
+        std::fwrite(&rec, sizeof(rec), 1, jitdump);
+        std::fwrite(name, name_size, 1, jitdump);
+        std::fwrite((const void *)addr, size, 1, jitdump);          //- Code itself
+
+        std::fflush(jitdump);
+    }
+
+#endif
+}
@@ -0,0 +1,40 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_JIT_EVENTS_H
+#define VOIDC_JIT_EVENTS_H
+
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+//- JIT code registration (opt-in, for profilers and debuggers)
+//---------------------------------------------------------------------
+//- perf map:  /tmp/perf-<pid>.map   ("perf report" as is)
+//- jitdump:   jit-<pid>.dump        (in $JITDUMPDIR or ".", needs
+//-                                   "perf record -k mono" + "perf inject --jit")
+//- gdb:       GDB JIT interface     (see voidc_global_ctx_t::static_initialize)
+//-
+//- Must be initialized before voidc_global_ctx_t::static_initialize...
+//---------------------------------------------------------------------
+enum voidc_jit_events_t
+{
+    voidc_jit_events_perf_map = 1,
+    voidc_jit_events_jitdump  = 2,
+    voidc_jit_events_gdb      = 4,
+};
+
+
+//---------------------------------------------------------------------
+void voidc_jit_events_initialize(int flags);
+void voidc_jit_events_terminate(void);
+
+int voidc_jit_events_flags(void);
+
+bool voidc_jit_events_code_enabled(void);           //- perf map or jitdump
+
+void voidc_jit_events_code_load(const char *name, uint64_t addr, uint64_t size);
+
+
+#endif      //- VOIDC_JIT_EVENTS_H
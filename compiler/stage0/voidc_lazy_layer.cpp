@@ -0,0 +1,73 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_lazy_layer.h"
+
+#include "voidc_target.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+
+//---------------------------------------------------------------------
+using namespace llvm;
+using namespace llvm::orc;
+
+
+//---------------------------------------------------------------------
+static void
+lazy_compile_failed(void)
+{
+    printf("\nLazy compilation failed\n");
+
+    abort();        //- Sic !!!
+}
+
+//---------------------------------------------------------------------
+lazy_layer_t::lazy_layer_t(LLJIT &jit, std::unique_ptr<LazyCallThroughManager> _lctm)
+  : lctm(std::move(_lctm)),
+    opt_layer(jit.getExecutionSession(), jit.getIRCompileLayer()),
+    cod_layer(jit.getExecutionSession(), opt_layer, *lctm,
+              createLocalIndirectStubsManagerBuilder(jit.getTargetTriple()))
+{
+    opt_layer.setTransform([this](ThreadSafeModule tsm, MaterializationResponsibility &) -> Expected<ThreadSafeModule>
+    {
+        std::lock_guard<std::mutex> lock(pipeline_mutex);
+
+        if (auto err = tsm.withModuleDo([this](Module &module)
+                       {
+                           return  pipeline.optimize(module, voidc_global_ctx_t::get_opt_level(false));
+                       }))
+        {
+            return  std::move(err);
+        }
+
+        return  std::move(tsm);
+    });
+
+    cod_layer.setPartitionFunction(CompileOnDemandLayer::compileRequested);
+}
+
+lazy_layer_t *
+lazy_layer_t::create(LLJIT &jit)
+{
+#if LLVM_VERSION_MAJOR < 16
+    auto lctm = createLocalLazyCallThroughManager(jit.getTargetTriple(),
+                                                  jit.getExecutionSession(),
+                                                  pointerToJITTargetAddress(&lazy_compile_failed));
+#else
+    auto lctm = createLocalLazyCallThroughManager(jit.getTargetTriple(),
+                                                  jit.getExecutionSession(),
+                                                  ExecutorAddr::fromPtr(&lazy_compile_failed));
+#endif
+
+    if (!lctm)
+    {
+        printf("\n%s\n", toString(lctm.takeError()).c_str());
+
+        return nullptr;
+    }
+
+    return  new lazy_layer_t(jit, std::move(*lctm));
+}
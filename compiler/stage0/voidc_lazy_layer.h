@@ -0,0 +1,54 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_LAZY_LAYER_H
+#define VOIDC_LAZY_LAYER_H
+
+#include "voidc_compile_pipeline.h"
+
+#include <memory>
+#include <mutex>
+
+#include <llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h>
+#include <llvm/ExecutionEngine/Orc/IRTransformLayer.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/LazyReexports.h>
+
+
+//---------------------------------------------------------------------
+//- Lazy layer
+//---------------------------------------------------------------------
+//- Compile-on-demand over LLJIT's IR compile layer: lazy reexports
+//- (stubs) for functions, each one is extracted, optimized and compiled
+//- on its first call. Materialization may happen on any thread which
+//- calls a stub - hence the mutex around the (single) pipeline...
+//---------------------------------------------------------------------
+class lazy_layer_t
+{
+public:
+    lazy_layer_t(llvm::orc::LLJIT &jit, std::unique_ptr<llvm::orc::LazyCallThroughManager> lctm);
+    ~lazy_layer_t() = default;
+
+public:
+    llvm::Error add(llvm::orc::JITDylib &jd, llvm::orc::ThreadSafeModule tsm)
+    {
+        return  cod_layer.add(jd, std::move(tsm));
+    }
+
+public:
+    static lazy_layer_t *create(llvm::orc::LLJIT &jit);
+
+private:
+    std::unique_ptr<llvm::orc::LazyCallThroughManager> lctm;
+
+    compile_pipeline_t pipeline{true};      //- Own target machines
+
+    std::mutex pipeline_mutex;
+
+    llvm::orc::IRTransformLayer     opt_layer;
+    llvm::orc::CompileOnDemandLayer cod_layer;
+};
+
+
+#endif  //- VOIDC_LAZY_LAYER_H
@@ -9,9 +9,20 @@
 #include "vpeg_context.h"
 #include "vpeg_voidc.h"
 #include "voidc_stdio.h"
+#include "voidc_ast_serial.h"
+#include "voidc_jit_events.h"
+#include "voidc_file_util.h"
+#include "voidc_parse_cache.h"
+#include "voidc_import_binary.h"
+#include "voidc_import_prefetch.h"
+#include "voidc_import_manifest.h"
+#include "voidc_import_cas.h"
+#include "voidc_build_cache.h"
 
 #include <list>
 #include <memory>
+#include <set>
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
@@ -29,6 +40,8 @@
 
 #include <llvm-c/Core.h>
 
+#include <llvm/Support/MemoryBuffer.h>
+
 
 //---------------------------------------------------------------------
 //- Some utility...
@@ -50,7 +63,7 @@ parse_unit(void)
 {
     auto &ctx = vpeg::context_data_t::current_ctx;
 
-    static const auto unit_q = v_quark_from_string("unit");
+    constexpr v_quark_t unit_q = v_static_quark_unit;
 
     auto ret = ctx->grammar->parse(ctx->grammar, unit_q, ctx);
 
@@ -133,16 +146,28 @@ import_paths_initialize(fs::path &exe_path)
 
 #undef PATHSEP
 
+
+static import_manifest_t import_manifest;
+
+
 //--------------------------------------------------------------------
 static fs::path
 find_file_for_import(const fs::path &parent, const fs::path &filename)
 {
+    auto key = std::make_pair(parent.generic_u8string(), filename.generic_u8string());
+
+    if (auto r = import_manifest.find_resolution(key))  return fs::u8path(*r);
+
+    std::vector<fs::path> probed;           //- For the manifest
+
     fs::path ret;
 
     if (filename.is_relative())
     {
         auto p = parent / filename;
 
+        probed.push_back(p);
+
         if (fs::exists(p))
         {
             ret = p;
@@ -153,6 +178,8 @@ find_file_for_import(const fs::path &parent, const fs::path &filename)
             {
                 auto p = it / filename;
 
+                probed.push_back(p);
+
                 if (fs::exists(p))
                 {
                     ret = p;
@@ -165,16 +192,24 @@ find_file_for_import(const fs::path &parent, const fs::path &filename)
     else if (fs::exists(filename))
     {
         ret = filename;
+
+        probed.push_back(ret);
     }
 
     if (fs::is_directory(ret))
     {
         ret = ret / "__import__.void";
+
+        probed.push_back(ret);
     }
 
     if (fs::is_regular_file(ret))
     {
-        return  fs::canonical(ret);
+        ret = fs::canonical(ret);
+
+        import_manifest.add_resolution(key, ret, probed);
+
+        return ret;
     }
 
     return  "";
@@ -182,41 +217,27 @@ find_file_for_import(const fs::path &parent, const fs::path &filename)
 
 
 //--------------------------------------------------------------------
-static inline
-std::FILE *
-my_fopen(const fs::path &fpath, bool write=false)
-{
-
-#ifdef _WIN32
-
-    return _wfopen(fpath.c_str(), (write ? L"wb" : L"rb"));
-
-#else
-
-    return std::fopen(fpath.c_str(), (write ? "wb" : "rb"));
-
-#endif
+extern "C"
+LLVMValueRef v_target_global_ctx_get_constant_value(base_global_ctx_t *, v_quark_t);
 
-}
+extern "C"
+void voidc_set_opt_level(bool unit_action, int level);
 
-static inline
-void
-my_fread(void* buf, size_t sz, size_t cn, std::FILE* f)
-{
-    auto dummy = std::fread(buf, sz, cn, f);
-}
+extern "C"
+size_t voidc_get_unit_action_count(int kind);
 
+extern "C"
+void voidc_set_compile_threads(int n);
 
-//--------------------------------------------------------------------
 extern "C"
-LLVMValueRef v_target_global_ctx_get_constant_value(base_global_ctx_t *, v_quark_t);
+void voidc_enable_lazy_modules(bool f);
 
 static fs::path
 obtain_import_bin_filepath(base_global_ctx_t *gctx, const fs::path &src_filename)
 {
-    static const v_quark_t prefix_q  = v_quark_from_string("voidc.import_bin_filename_prefix");
-    static const v_quark_t suffix_q  = v_quark_from_string("voidc.import_bin_filename_suffix");
-    static const v_quark_t rewrite_q = v_quark_from_string("voidc.import_bin_filename_rewrite");
+    constexpr v_quark_t prefix_q  = v_static_quark_voidc_import_bin_filename_prefix;
+    constexpr v_quark_t suffix_q  = v_static_quark_voidc_import_bin_filename_suffix;
+    constexpr v_quark_t rewrite_q = v_static_quark_voidc_import_bin_filename_rewrite;
 
     const char *prefix = "__voidcache__/";      //- ?
     const char *suffix = "c";                   //- ?
@@ -242,14 +263,15 @@ obtain_import_bin_filepath(base_global_ctx_t *gctx, const fs::path &src_filename
 }
 
 
-//--------------------------------------------------------------------
-static
-const char magic[8] = ".voidc\n";
+static import_prefetcher_t import_prefetcher;
 
+
+//--------------------------------------------------------------------
 enum import_state_t
 {
     ist_unknown,        //- ...
     ist_good,           //- Usable binary
+    ist_stale,          //- Only the source changed, units prefix is reusable
     ist_bad             //- Need (re)compile
 };
 
@@ -266,7 +288,7 @@ check_import_state(const fs::path &src_filepath, const fs::path &bin_filepath)
 
         if (it != import_state.end())
         {
-            return  (it->second != ist_bad);            //- "unknown" => kinda "good"...
+            return  (it->second == ist_good  ||  it->second == ist_unknown);        //- "unknown" => kinda "good"...
         }
     }
 
@@ -283,6 +305,8 @@ check_import_state(const fs::path &src_filepath, const fs::path &bin_filepath)
 
     bool use_binary = true;
 
+    bool source_changed = false;
+
     fs::file_time_type bin_time;
 
     //- First, check bin_absolute itself
@@ -296,7 +320,7 @@ check_import_state(const fs::path &src_filepath, const fs::path &bin_filepath)
         auto st  = fs::last_write_time(src_filepath);
         bin_time = fs::last_write_time(bin_absolute);
 
-        if (st > bin_time)  use_binary = false;
+        if (st > bin_time)  source_changed = true;      //- Check the rest anyway...
     }
 
     if (!use_binary)
@@ -306,93 +330,76 @@ check_import_state(const fs::path &src_filepath, const fs::path &bin_filepath)
         return false;
     }
 
-    //- Second, check for header ...
-
-    std::FILE *infs = my_fopen(bin_absolute);
-
-    size_t buf_len = sizeof(magic);
-    auto buf = std::make_unique<char[]>(buf_len);
+    //- Second, check for header (and map it for the replay) ...
 
-    std::memset(buf.get(), 0, buf_len);
+    auto *binary = open_import_binary(bin_absolute);
 
-    my_fread(buf.get(), buf_len, 1, infs);
-
-    if (std::strcmp(magic, buf.get()) != 0)
+    if (!binary)
     {
         import_state[{src_filepath_str, bin_filepath_str}] = ist_bad;
 
-        std::fclose(infs);
-
         return false;
     }
 
-    //- Now, check for imports ...
-
-    my_fread(buf.get(), sizeof(size_t), 1, infs);
+    //- Resolve imports and prefetch their binaries (checked depth-first below) ...
 
-    std::fseek(infs, *((size_t *)buf.get()), SEEK_SET);
+    std::vector<std::pair<fs::path, fs::path>> imp_files;       //- (source, binary)
 
-    while(use_binary)
+    for (auto &imp : binary->imports)
     {
-        size_t len;
-
-        my_fread(&len, sizeof(len), 1, infs);
+        fs::path imp_filename = find_file_for_import(parent_path, fs::u8path(imp.first));
 
-        if (std::feof(infs))  break;        //- WTF ?!?!?
+        fs::path bin_impfile = fs::u8path(imp.second);
 
-        if (len == 0)  break;
-
-        if (buf_len < len)
+        if (!imp_filename.empty())
         {
-            buf = std::make_unique<char[]>(len);
+            if (bin_impfile.is_relative())  bin_impfile = imp_filename.parent_path() / bin_impfile;
 
-            buf_len = len;
+            import_prefetcher.push(bin_impfile);
         }
 
-        my_fread(buf.get(), len, 1, infs);
+        imp_files.emplace_back(std::move(imp_filename), std::move(bin_impfile));
+    }
 
-        std::string name(buf.get(), len);
+    //- Now, check for imports ...
 
-        fs::path imp_filename = fs::u8path(name);
+    for (size_t i=0; i < imp_files.size(); ++i)
+    {
+        auto &name = binary->imports[i].first;
 
-        imp_filename = find_file_for_import(parent_path, imp_filename);
+        auto &imp_filename = imp_files[i].first;
 
         if (!fs::exists(imp_filename))
         {
             throw std::runtime_error("Import file not found: " + name);
         }
 
-        my_fread(&len, sizeof(len), 1, infs);
-
-        if (buf_len < len)
-        {
-            buf = std::make_unique<char[]>(len);
-
-            buf_len = len;
-        }
-
-        my_fread(buf.get(), len, 1, infs);
-
-        std::string bstr(buf.get(), len);
-
-        fs::path bfil = fs::u8path(bstr);
+        fs::path bfil = fs::u8path(binary->imports[i].second);
 
         use_binary = check_import_state(imp_filename, bfil);
 
         if (use_binary)
         {
-            fs::path bin_impfile;
-
-            if (bfil.is_absolute()) bin_impfile = bfil;
-            else                    bin_impfile = imp_filename.parent_path() / bfil;
+            auto &bin_impfile = imp_files[i].second;
 
             auto bt = fs::last_write_time(bin_impfile);
 
             if (bt > bin_time)  use_binary = false;
         }
+
+        if (!use_binary)  break;
+    }
+
+    if (use_binary  &&  source_changed)         //- Keep it mapped for the prefix replay
+    {
+        import_state[{src_filepath_str, bin_filepath_str}] = ist_stale;
+
+        return false;
     }
 
-    std::fclose(infs);
+    if (!use_binary)  close_import_binary(bin_absolute);     //- Will be rewritten...
+
+    if (use_binary)  import_manifest.add_import({src_filepath_str, bin_filepath_str}, src_filepath, bin_absolute);
 
     import_state[{src_filepath_str, bin_filepath_str}] = (use_binary ? ist_good : ist_bad);
 
@@ -401,74 +408,58 @@ check_import_state(const fs::path &src_filepath, const fs::path &bin_filepath)
 
 
 //--------------------------------------------------------------------
-//- ...
+//- Import manifest is valid for the same import paths only...
 //--------------------------------------------------------------------
-struct out_binary_t
+static std::string
+import_paths_key(void)
 {
-    explicit out_binary_t(const fs::path &filename)
-      : out_path(filename),
-        tmp_path(filename)
-    {
-        fs::create_directories(filename.parent_path());         //- Sic !?!
-
-        tmp_path += "_XXXXXX";
-
-        fs::path::string_type tmp_name = tmp_path.native();
-
-#ifdef _WIN32
+    std::string ret;
 
-        int fd = -1;
+    for (auto &p : import_paths)  ret += p.generic_u8string() + '\n';
 
-        static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-
-        int len = int(tmp_name.size());
+    return ret;
+}
 
-        auto *template_name = tmp_name.data();
 
-        for (int i=0; i >= 0; i++)
-        {
-            for (int j=len-6; j < len; j++)
-            {
-                template_name[j] = letters[std::rand()/(RAND_MAX/61)];
-            }
+//--------------------------------------------------------------------
+//- Content-addressed import cache (see voidc_import_cas.h)
+//--------------------------------------------------------------------
+static fs::path voidc_exe_path;
 
-            fd = _wsopen(template_name,
-                         _O_RDWR|_O_CREAT|_O_EXCL|_O_BINARY,
-                         _SH_DENYRW,
-                         _S_IREAD|_S_IWRITE
-                        );
+static import_cas_t import_cas;         //- See main()
 
-            if (fd != -1  ||  errno != EEXIST) break;
-        }
 
-        assert(fd != -1);       //- ?..
+//--------------------------------------------------------------------
+//- Grammar environment: imports (see voidc_parse_cache.h)
+//--------------------------------------------------------------------
+static std::map<std::string, fs::path> imported_binaries;      //- Source -> binary used
 
-#else
+static uint64_t
+voidc_identity(void)
+{
+    static const uint64_t identity = binary_identity(voidc_exe_path);
 
-        int fd = mkstemp(tmp_name.data());
+    return identity;
+}
 
-#endif
+static void
+grammar_env_add_import(const std::string &src_filepath_str)
+{
+    if (!grammar_env_t::current)  return;
 
-        tmp_path = tmp_name.c_str();
+    uint64_t identity;
 
-        f = ::fdopen(fd, "wb");
+    if (auto it = imported_binaries.find(src_filepath_str);  it != imported_binaries.end())
+    {
+        identity = binary_identity(it->second);
     }
-
-    ~out_binary_t()
+    else
     {
-        std::fclose(f);
-
-        fs::rename(tmp_path, out_path);
+        identity = text_hash(src_filepath_str);
     }
 
-public:
-    FILE *f = nullptr;
-
-private:
-    const fs::path out_path;
-
-    fs::path tmp_path;
-};
+    grammar_env_t::current->add_import(identity);
+}
 
 
 //--------------------------------------------------------------------
@@ -476,6 +467,8 @@ private:
 //--------------------------------------------------------------------
 static bool trace_imports = false;
 
+static bool print_unit_stats = false;
+
 static void
 v_import_helper(const char *name, bool _export)
 {
@@ -523,6 +516,8 @@ v_import_helper(const char *name, bool _export)
                 for (auto &e : s.second)  e.first(e.second);    //- Run(!) efforts...
             }
 
+            grammar_env_add_import(src_filepath_str);
+
             if (_export  &&  target_lctx->export_data)
             {
                 auto res_e = target_lctx->exported.insert(src_filepath_str);
@@ -543,14 +538,31 @@ v_import_helper(const char *name, bool _export)
         export_data = &it->second;
     }
 
-    {   bool use_binary = check_import_state(src_filepath, bin_filepath);
+    {   fs::path ca_dir;
+
+        if (&tctx == &vctx)  ca_dir = import_cas_t::cache_dir(&tctx);
+
+        std::string ca_key;
+
+        if (!ca_dir.empty())  ca_key = import_cas.full_key(ca_dir, src_filepath);
+
+        bool use_binary;
 
         fs::path bin_absolute;
 
-        if (bin_filepath.is_absolute()) bin_absolute = bin_filepath;
-        else                            bin_absolute = src_filepath.parent_path() / bin_filepath;
+        if (!ca_key.empty()  &&  open_import_binary(ca_dir / (ca_key + ".voidc")))
+        {
+            bin_absolute = ca_dir / (ca_key + ".voidc");
+
+            use_binary = true;
+        }
+        else
+        {
+            use_binary = check_import_state(src_filepath, bin_filepath);
 
-        std::FILE *infs;
+            if (bin_filepath.is_absolute()) bin_absolute = bin_filepath;
+            else                            bin_absolute = src_filepath.parent_path() / bin_filepath;
+        }
 
         voidc_local_ctx_t lctx(vctx);
 
@@ -563,68 +575,44 @@ v_import_helper(const char *name, bool _export)
 
         if (use_binary)
         {
-            infs = my_fopen(bin_absolute);
+            auto *binary = open_import_binary(bin_absolute);        //- Mapped by check_import_state
 
-            size_t buf_len = sizeof(magic);
-            auto buf = std::make_unique<char[]>(buf_len);
-
-            std::memset(buf.get(), 0, buf_len);
-
-            my_fread(buf.get(), buf_len, 1, infs);
-
-            assert(std::strcmp(magic, buf.get()) == 0);
-
-            std::fseek(infs, sizeof(size_t), SEEK_CUR);         //- Skip pointer to imports
-
-            auto parent_vpeg_ctx = vpeg::context_data_t::current_ctx;
-
-            vpeg::context_data_t::current_ctx = nullptr;
-
-            while(!std::feof(infs))
+            if (!binary)
             {
-                size_t len;
-
-                my_fread(&len, sizeof(len), 1, infs);
-
-                if (std::feof(infs))  break;        //- WTF ?!?!?
+                throw std::runtime_error("Bad import binary: " + bin_absolute.generic_u8string());
+            }
 
-                if (len == 0)  break;
+            auto parent_vpeg_ctx = vpeg::context_data_t::current_ctx;
 
-                if (buf_len < len)
-                {
-                    buf = std::make_unique<char[]>(len);
+            auto parent_grammar_env = grammar_env_t::current;
 
-                    buf_len = len;
-                }
+            vpeg::context_data_t::current_ctx = nullptr;
 
-                my_fread(buf.get(), len, 1, infs);
+            grammar_env_t::current = nullptr;        //- The binary's identity covers its imports
 
-                lctx.unit_buffer = LLVMCreateMemoryBufferWithMemoryRange(buf.get(), len, "unit_buffer", false);
+            replay_unit_records(lctx, binary->units, binary->buffer->getBufferEnd());
 
-                lctx.run_unit_action();
+            vpeg::context_data_t::current_ctx = parent_vpeg_ctx;
 
-                LLVMDisposeMemoryBuffer(lctx.unit_buffer);
+            grammar_env_t::current = parent_grammar_env;
 
-                lctx.unit_buffer = nullptr;
-            }
-
-            vpeg::context_data_t::current_ctx = parent_vpeg_ctx;
+            close_import_binary(bin_absolute);
         }
         else        //- !use_binary
         {
             if (trace_imports)  printf("start:  %s\n", src_filepath_str.c_str());
 
-            infs = my_fopen(src_filepath);
+            std::FILE *infs = my_fopen(src_filepath);
 
             out_binary_t out_binary(bin_absolute);
 
             const auto &outfs = out_binary.f;
 
-            {   char buf[sizeof(magic)];
+            {   char buf[sizeof(import_binary_magic)];
 
-                std::memset(buf, 0, sizeof(magic));
+                std::memset(buf, 0, sizeof(import_binary_magic));
 
-                std::fwrite(buf, sizeof(magic), 1, outfs);
+                std::fwrite(buf, sizeof(import_binary_magic), 1, outfs);
 
                 std::fwrite(buf, sizeof(size_t), 1, outfs);         //- Pointer to imports...
             }
@@ -635,8 +623,196 @@ v_import_helper(const char *name, bool _export)
 
                 vpeg::context_data_t::current_ctx = std::make_shared<vpeg::context_data_t>(infs, grm);
 
-                while(auto unit = parse_unit())
+                fs::path ast_absolute = bin_absolute;
+
+                ast_absolute += ".ast";
+
+                parse_cache_t parse_cache(ast_absolute, parse_unit);
+
+                auto &ctx = vpeg::context_data_t::current_ctx;
+
+                grammar_env_t grammar_env(voidc_identity());
+
+                auto parent_grammar_env = grammar_env_t::current;
+
+                grammar_env_t::current = &grammar_env;
+
+                record_writer_t writer = {outfs, obtain_record_codec(&tctx)};
+
+                voidc_local_ctx_t::module_records_t module_records;
+
+                module_records.put     = put_module_record;
+                module_records.put_aux = &writer;
+
+                lctx.module_records = &module_records;
+
+                if (auto it = import_state.find({src_filepath_str, bin_filepath_str});
+                    it != import_state.end()  &&  it->second == ist_stale)
                 {
+                    //- Only the source changed: replay the old binary's units
+                    //- while their text (and grammar) is the same...
+
+                    auto *binary = open_import_binary(bin_absolute);        //- Mapped by check_import_state
+
+                    const char *p   = (binary ? binary->units : nullptr);
+                    const char *end = (binary ? binary->buffer->getBufferEnd() : nullptr);
+
+                    size_t count = 0;
+
+                    struct module_t
+                    {
+                        unit_header_t h;
+
+                        const char *data;
+                        size_t      len;
+                    };
+
+                    std::vector<module_t> modules;          //- Of the next unit
+
+                    auto unpack = [](const unit_header_t &h, const char *&data, size_t &len, llvm::SmallVectorImpl<uint8_t> &raw)
+                    {
+                        if (h.codec == record_codec_none)  return true;
+
+                        if (!decompress_record(h, data, len, raw))  return false;
+
+                        data = (const char *)raw.data();
+                        len  = raw.size();
+
+                        return true;
+                    };
+
+                    while(end - p >= ptrdiff_t(sizeof(size_t)))
+                    {
+                        size_t len;
+
+                        std::memcpy(&len, p, sizeof(len));
+
+                        if (len < sizeof(unit_header_t)  ||  size_t(end - p) - sizeof(len) < len)  break;
+
+                        unit_header_t h;
+
+                        std::memcpy(&h, p + sizeof(len), sizeof(h));
+
+                        const char *data = p + sizeof(len) + sizeof(h);
+
+                        size_t data_len = len - sizeof(h);
+
+                        size_t step = sizeof(len) + std::min(align_unit_size(len), size_t(end - p) - sizeof(len));
+
+                        p += step;
+
+                        if (is_module_record(h.kind))
+                        {
+                            modules.push_back({h, data, data_len});         //- Goes with its unit, if any
+
+                            continue;
+                        }
+
+                        size_t start = ctx->get_position();
+
+                        if (h.start != start  ||  h.end < h.start  ||  h.extent < h.end)  break;
+
+                        if (h.grammar_fp != grammar_env.unit_key())  break;
+
+                        ctx->fill_buffer(h.extent);
+
+                        if (ctx->get_buffer_size() < h.extent)  break;          //- Got shorter...
+
+                        if (text_hash(ctx->take_string(start, h.extent)) != h.text_hash)  break;
+
+                        //- Same unit, reuse it (with its modules)
+
+                        llvm::SmallVector<uint8_t, 0> raw;
+
+                        if (!unpack(h, data, data_len, raw))  break;
+
+                        std::vector<std::pair<const char *, size_t>> views;
+
+                        for (auto &m : modules)
+                        {
+                            llvm::SmallVector<uint8_t, 0> m_raw;
+
+                            const char *m_data = m.data;
+                            size_t      m_len  = m.len;
+
+                            if (!unpack(m.h, m_data, m_len, m_raw))  break;
+
+                            if (m.h.codec != record_codec_none)
+                            {
+                                m_data = module_records.owned.emplace_front(m_data, m_len).data();
+                            }
+
+                            views.emplace_back(m_data, m_len);
+                        }
+
+                        if (views.size() != modules.size())  break;
+
+                        for (size_t i=0; i<views.size(); ++i)
+                        {
+                            auto &v = views[i];
+
+                            module_records.views.push_back(v);
+
+                            put_module_record(&writer, v.first, v.second, modules[i].h.kind == unit_record_module_lazy);
+                        }
+
+                        modules.clear();
+
+                        grammar_env.begin_unit();
+
+                        if (data_len)
+                        {
+                            lctx.unit_buffer = LLVMCreateMemoryBufferWithMemoryRange(data, data_len, "unit_buffer", false);     //- View
+
+                            lctx.run_unit_action();
+
+                            LLVMDisposeMemoryBuffer(lctx.unit_buffer);
+
+                            lctx.unit_buffer = nullptr;
+                        }
+
+                        grammar_env.end_unit(h.text_hash);
+
+                        writer.write(h, data, data_len);
+
+                        auto st = ctx->get_state();
+
+                        st.position = h.end;
+
+                        ctx->set_state(st);
+
+                        parse_cache.keep_unit(start);
+
+                        ++count;
+                    }
+
+                    if (trace_imports)  printf("reuse:  %s (%zu units)\n", src_filepath_str.c_str(), count);
+
+                    close_import_binary(bin_absolute);          //- Will be rewritten...
+
+                    for (auto &v : module_records.views)  v = {nullptr, 0};        //- Unmapped...
+                }
+
+                for (;;)
+                {
+                    unit_header_t h = {};
+
+                    h.kind = unit_record_unit;
+
+                    grammar_env.begin_unit();
+
+                    h.start      = ctx->get_position();
+                    h.grammar_fp = grammar_env.unit_key();
+
+                    auto unit = parse_cache.parse_unit(h.grammar_fp);
+
+                    if (!unit)  break;
+
+                    h.end    = ctx->get_position();
+                    h.extent = ctx->get_buffer_size();      //- The parser looked at [start, extent) at most
+
+                    h.text_hash = text_hash(ctx->take_string(h.start, h.extent));
+
                     voidc_visitor_data_t::visit(lctx.compiler, unit);
 
                     unit.reset();
@@ -645,18 +821,26 @@ v_import_helper(const char *name, bool _export)
 
                     if (lctx.unit_buffer)   //- Sic!
                     {
-                        size_t len = LLVMGetBufferSize(lctx.unit_buffer);
-
-                        std::fwrite((char *)&len, sizeof(len), 1, outfs);
-
-                        std::fwrite(LLVMGetBufferStart(lctx.unit_buffer), len, 1, outfs);
+                        writer.write(h, LLVMGetBufferStart(lctx.unit_buffer), LLVMGetBufferSize(lctx.unit_buffer));
 
                         LLVMDisposeMemoryBuffer(lctx.unit_buffer);
 
                         lctx.unit_buffer = nullptr;
                     }
+                    else
+                    {
+                        writer.write(h, nullptr, 0);
+                    }
+
+                    grammar_env.end_unit(h.text_hash);
                 }
 
+                grammar_env_t::current = parent_grammar_env;
+
+                lctx.module_records = nullptr;
+
+                parse_cache.save();
+
                 vpeg::context_data_t::current_ctx = parent_vpeg_ctx;
             }
 
@@ -693,16 +877,27 @@ v_import_helper(const char *name, bool _export)
 
             std::fseek(outfs, 0, SEEK_SET);
 
-            std::fwrite(magic, sizeof(magic), 1, outfs);
+            std::fwrite(import_binary_magic, sizeof(import_binary_magic), 1, outfs);
 
             std::fwrite((char *)&imports_pos, sizeof(imports_pos), 1, outfs);
 
             if (trace_imports)  printf("finish: %s\n", src_filepath_str.c_str());
+
+            std::fclose(infs);
         }
 
-        std::fclose(infs);
+        if (!use_binary)        //- Published by now...
+        {
+            import_manifest.add_import({src_filepath_str, bin_filepath.generic_u8string()}, src_filepath, bin_absolute);
+
+            if (!ca_dir.empty())  import_cas.publish(ca_dir, src_filepath, lctx.imports, bin_absolute);
+        }
+
+        imported_binaries[src_filepath_str] = bin_absolute;
     }
 
+    grammar_env_add_import(src_filepath_str);
+
     //- ...
 
     target_lctx->decls.insert(export_data->first);              //- Insert declarations
@@ -810,6 +1005,38 @@ VOIDC_DLLEXPORT_END
 }   //- extern "C"
 
 
+//--------------------------------------------------------------------
+//- Import cache warm-up (see voidc_build_cache.h)
+//--------------------------------------------------------------------
+enum cache_mode_t
+{
+    cache_mode_none,
+    cache_mode_build,           //- Driver
+    cache_mode_worker           //- Import sources, then exit
+};
+
+
+//--------------------------------------------------------------------
+static int
+int_option(char opt, const char *arg, int min, int max)
+{
+    char *end = nullptr;
+
+    errno = 0;
+
+    long v = std::strtol(arg, &end, 10);
+
+    if (errno  ||  end == arg  ||  *end  ||  v < min  ||  v > max)
+    {
+        fprintf(stderr, "voidc: bad -%c argument: \"%s\" (expected %d..%d)\n", opt, arg, min, max);
+
+        std::exit(1);
+    }
+
+    return int(v);
+}
+
+
 //--------------------------------------------------------------------
 static void
 voidc_flush_output(void)
@@ -850,16 +1077,51 @@ main(int argc, char *argv[])
         exe_path = "/proc/self/exe";
 #endif
 
+        {   std::error_code ec;         //- Sic! The real file, not the link
+
+            auto p = fs::canonical(exe_path, ec);
+
+            if (!ec)  exe_path = p;
+        }
+
+        voidc_exe_path = exe_path;
+
         import_paths_initialize(exe_path);
     }
 
+    auto cache_mode = cache_mode_none;
+
+    for (int i=1; i<argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--build-cache") == 0)             cache_mode = cache_mode_build;
+        else if (std::strcmp(argv[i], "--build-cache-worker") == 0) cache_mode = cache_mode_worker;
+        else continue;
+
+        std::memmove(argv+i, argv+i+1, (argc-i)*sizeof(char *));     //- With argv[argc]
+
+        --argc;
+
+        break;
+    }
+
     std::list<std::string> sources;
 
+    std::vector<std::string> worker_args;   //- See build_import_cache
+
+    int opt_level_module      = -1;         //- Not forced
+    int opt_level_unit_action = -1;         //- Not forced
+
+    int compile_threads = -1;               //- Not set: no partitioning, one cache worker per CPU
+
+    bool lazy_modules = false;
+
+    int jit_events = 0;                     //- See voidc_jit_events_t
+
     while (optind < argc)
     {
         char c;
 
-        if ((c = getopt(argc, argv, "-I:s:T")) != -1)
+        if ((c = getopt(argc, argv, "-I:s:TSO:U:j:LJ:")) != -1)
         {
             //- Option argument
 
@@ -867,6 +1129,7 @@ main(int argc, char *argv[])
             {
             case 'I':
                 import_paths.push_back(optarg);
+                worker_args.insert(worker_args.end(), {"-I", optarg});
                 break;
 
             case 's':
@@ -876,6 +1139,36 @@ main(int argc, char *argv[])
 
             case 'T':
                 trace_imports = true;
+                worker_args.push_back("-T");
+                break;
+
+            case 'S':
+                print_unit_stats = true;
+                break;
+
+            case 'O':
+                opt_level_module = int_option(c, optarg, 0, 3);
+                worker_args.insert(worker_args.end(), {"-O", optarg});
+                break;
+
+            case 'U':
+                opt_level_unit_action = int_option(c, optarg, 0, 3);
+                worker_args.insert(worker_args.end(), {"-U", optarg});
+                break;
+
+            case 'j':
+                compile_threads = int_option(c, optarg, 0, 1024);
+                break;
+
+            case 'L':
+                lazy_modules = true;
+                worker_args.push_back("-L");
+                break;
+
+            case 'J':               //- Comma separated: perf, jitdump, gdb
+                if (std::strstr(optarg, "perf"))     jit_events |= voidc_jit_events_perf_map;
+                if (std::strstr(optarg, "jitdump"))  jit_events |= voidc_jit_events_jitdump;
+                if (std::strstr(optarg, "gdb"))      jit_events |= voidc_jit_events_gdb;
                 break;
 
             case 1:
@@ -892,10 +1185,25 @@ main(int argc, char *argv[])
 
     if (sources.empty())  sources.push_back("-");
 
+    voidc_jit_events_initialize(jit_events);        //- Sic! Before JIT
+
+    std::string options_key = std::to_string(opt_level_module) + ' ' +
+                              std::to_string(opt_level_unit_action) + ' ' +
+                              std::to_string(lazy_modules);
+
+    import_cas.initialize(voidc_exe_path, options_key, find_file_for_import);
+
     voidc_global_ctx_t::static_initialize();
 
     auto &gctx = *voidc_global_ctx_t::voidc;
 
+    voidc_set_opt_level(false, opt_level_module);
+    voidc_set_opt_level(true,  opt_level_unit_action);
+
+    if (compile_threads >= 0)  voidc_set_compile_threads(compile_threads);     //- Opt-in
+
+    voidc_enable_lazy_modules(lazy_modules);
+
     utility::static_initialize();
 
     {   v_type_t *import_f_type = gctx.make_function_type(gctx.void_type, &gctx.char_ptr_type, 1, false);
@@ -942,16 +1250,82 @@ main(int argc, char *argv[])
 
     make_level_0_target_compiler();         //- Sic !!!
 
+    for (auto &src : sources)
+    {
+        if (cache_mode != cache_mode_none)  break;
+
+        if (src == "-")  continue;
+
+        fs::path src_path = fs::u8path(src);
+
+        if (!fs::exists(src_path))  break;      //- See below...
+
+        src_path = fs::canonical(src_path);
+
+        fs::path manifest_path = obtain_import_bin_filepath(&gctx, src_path);
+
+        if (!manifest_path.is_absolute())  manifest_path = src_path.parent_path() / manifest_path;
+
+        manifest_path += ".manifest";
+
+        import_manifest.load(manifest_path, import_paths_key());
+
+        for (auto &key : import_manifest.good_imports())
+        {
+            import_state[key] = ist_good;
+
+            fs::path bin = fs::u8path(key.second);
+
+            if (bin.is_relative())  bin = fs::u8path(key.first).parent_path() / bin;
+
+            import_prefetcher.push(bin);        //- All of them, right now
+        }
+
+        break;      //- Root: the first one
+    }
+
+    int ret = 0;
+
+    if (cache_mode == cache_mode_build)
+    {
+        build_cache_env_t env;
+
+        env.exe_path     = voidc_exe_path;
+        env.find_file    = find_file_for_import;
+        env.bin_filepath = obtain_import_bin_filepath;
+        env.check_import = check_import_state;
+        env.trace        = trace_imports;
+
+        ret = build_import_cache(sources, worker_args, compile_threads, env);
+
+        sources.clear();            //- Nothing to run...
+    }
+
     {   vpeg::grammar_t current_grammar = make_level_0_voidc_grammar();
 
         voidc_local_ctx_t lctx(gctx);
 
+        grammar_env_t grammar_env(voidc_identity());        //- Grammar goes on from source to source...
+
         for (auto &src : sources)
         {
+            if (cache_mode == cache_mode_worker)
+            {
+                if (src == "-")  continue;
+
+                lctx.filename = fs::canonical(fs::u8path(src)).generic_u8string();
+
+                v_import_helper(lctx.filename.c_str(), false);
+
+                continue;
+            }
+
             std::string src_name = src;
 
             std::FILE *istr;
 
+            std::unique_ptr<parse_cache_t> parse_cache;
+
             if (src == "-")
             {
                 src_name = "<stdin>";
@@ -972,6 +1346,14 @@ main(int argc, char *argv[])
                 istr = my_fopen(src_path);
 
                 src_name = src_path.generic_u8string();
+
+                fs::path ast_path = obtain_import_bin_filepath(&gctx, src_path);
+
+                if (!ast_path.is_absolute())  ast_path = src_path.parent_path() / ast_path;
+
+                ast_path += ".ast";
+
+                parse_cache = std::make_unique<parse_cache_t>(ast_path, parse_unit);
             }
 
             lctx.filename = src_name;
@@ -982,7 +1364,7 @@ main(int argc, char *argv[])
 
             {   auto &ctx = vpeg::context_data_t::current_ctx;
 
-                static const auto shebang_q = v_quark_from_string("shebang");
+                constexpr v_quark_t shebang_q = v_static_quark_shebang;
 
                 if (ctx->grammar->parsers.find(shebang_q))
                 {
@@ -992,8 +1374,22 @@ main(int argc, char *argv[])
                 }
             }
 
-            while(auto unit = parse_unit())
+            grammar_env_t::current = &grammar_env;
+
+            for(;;)
             {
+                auto &ctx = vpeg::context_data_t::current_ctx;
+
+                grammar_env.begin_unit();
+
+                size_t start = ctx->get_position();
+
+                auto unit = (parse_cache ? parse_cache->parse_unit(grammar_env.unit_key()) : parse_unit());
+
+                if (!unit)  break;
+
+                uint64_t unit_text_hash = text_hash(ctx->take_string(start, ctx->get_buffer_size()));
+
                 voidc_visitor_data_t::visit(lctx.compiler, unit);
 
                 unit.reset();
@@ -1003,8 +1399,14 @@ main(int argc, char *argv[])
                 LLVMDisposeMemoryBuffer(lctx.unit_buffer);
 
                 lctx.unit_buffer = nullptr;
+
+                grammar_env.end_unit(unit_text_hash);
             }
 
+            grammar_env_t::current = nullptr;
+
+            if (parse_cache)  parse_cache->save();
+
             current_grammar = vpeg::context_data_t::current_ctx->grammar;
 
             vpeg::context_data_t::current_ctx = nullptr;     //- ?
@@ -1013,6 +1415,27 @@ main(int argc, char *argv[])
         }
     }
 
+    import_manifest.save();
+
+    import_prefetcher.stop();
+
+    if (print_unit_stats)
+    {
+        size_t interpreted = voidc_get_unit_action_count(0);
+        size_t native      = voidc_get_unit_action_count(1);
+
+        double total = (interpreted + native ? double(interpreted + native) : 1.0);
+
+        fprintf(stderr, "unit actions: interpreted %zu (%.1f%%), native %zu (%.1f%%)\n",
+                interpreted, 100.0 * interpreted / total,
+                native,      100.0 * native / total);
+
+        fprintf(stderr, "compiled: loops %zu, unsupported %zu, interpreter disabled %zu\n",
+                voidc_get_unit_action_count(2),
+                voidc_get_unit_action_count(3),
+                voidc_get_unit_action_count(4));
+    }
+
     voidc_stdio_static_terminate();
 
     vpeg::context_data_t::static_terminate();
@@ -1023,7 +1446,9 @@ main(int argc, char *argv[])
     utility::static_terminate();
     voidc_global_ctx_t::static_terminate();
 
-    return 0;
+    voidc_jit_events_terminate();
+
+    return ret;
 }
 
 
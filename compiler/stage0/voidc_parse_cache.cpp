@@ -0,0 +1,306 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#include "voidc_parse_cache.h"
+
+#include "voidc_ast_serial.h"
+#include "voidc_file_util.h"
+#include "vpeg_context.h"
+
+#include <cstdio>
+#include <cstring>
+
+
+//---------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+
+//---------------------------------------------------------------------
+//- Hashes
+//---------------------------------------------------------------------
+uint64_t
+text_hash(const std::string &text)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for (unsigned char c : text)
+    {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+uint64_t
+hash_mix(uint64_t h, uint64_t v)
+{
+    for (int i=0; i<8; ++i)
+    {
+        h ^= (v >> (8*i)) & 0xFF;
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+uint64_t
+binary_identity(const fs::path &path)
+{
+    auto sig = file_signature(path);
+
+    uint64_t h = text_hash(path.generic_u8string());
+
+    h = hash_mix(h, uint64_t(sig.mtime));
+    h = hash_mix(h, sig.size);
+
+    return h;
+}
+
+
+//---------------------------------------------------------------------
+//- Grammar environment
+//---------------------------------------------------------------------
+grammar_env_t *grammar_env_t::current = nullptr;
+
+grammar_env_t::grammar_env_t(uint64_t voidc_identity)
+  : key(voidc_identity)
+{}
+
+//---------------------------------------------------------------------
+uint64_t
+grammar_env_t::unit_key(void) const
+{
+    auto &ctx = vpeg::context_data_t::current_ctx;
+
+    return  hash_mix(ctx->grammar->fingerprint(), key);
+}
+
+void
+grammar_env_t::begin_unit(void)
+{
+    grammar = vpeg::context_data_t::current_ctx->grammar;
+
+    imports  = 0;
+    imported = false;
+}
+
+void
+grammar_env_t::end_unit(uint64_t unit_text_hash)
+{
+    if (!imported  &&  grammar == vpeg::context_data_t::current_ctx->grammar)  return;
+
+    key = hash_mix(hash_mix(key, unit_text_hash), imports);
+}
+
+void
+grammar_env_t::add_import(uint64_t identity)
+{
+    imports  = hash_mix(imports, identity);
+    imported = true;
+}
+
+
+//---------------------------------------------------------------------
+//- Parsed units cache
+//---------------------------------------------------------------------
+static
+const char ast_magic[8] = ".vast2\n";
+
+//---------------------------------------------------------------------
+parse_cache_t::parse_cache_t(const fs::path &_filepath, parse_fun_t _parse)
+  : filepath(_filepath),
+    parse(_parse)
+{
+    load();
+}
+
+//---------------------------------------------------------------------
+void
+parse_cache_t::load(void)
+{
+    std::error_code ec;
+
+    if (!fs::exists(filepath, ec))  return;
+
+    auto *infs = my_fopen(filepath);
+
+    if (!infs)  return;
+
+    std::string data;
+
+    {   char buf[4096];
+
+        while(size_t n = std::fread(buf, 1, sizeof(buf), infs))  data.append(buf, n);
+    }
+
+    std::fclose(infs);
+
+    if (data.size() < sizeof(ast_magic)  ||  std::memcmp(data.data(), ast_magic, sizeof(ast_magic)) != 0)  return;
+
+    size_t pos = sizeof(ast_magic);
+
+    std::map<size_t, record_t> records;
+
+    for(;;)
+    {
+        size_t len;
+
+        if (data.size() - pos < sizeof(len))  return;       //- Broken...
+
+        std::memcpy(&len, data.data()+pos, sizeof(len));
+
+        pos += sizeof(len);
+
+        if (len == 0)  break;
+
+        if (len < sizeof(header_t)  ||  data.size() - pos < len)  return;       //- Broken...
+
+        record_t r;
+
+        std::memcpy(&r.header, data.data()+pos, sizeof(header_t));
+
+        {   auto &h = r.header;
+
+            if (h.end < h.start  ||  h.extent < h.end)  return;        //- Broken...
+        }
+
+        r.ast.assign(data.data()+pos+sizeof(header_t), len-sizeof(header_t));
+
+        pos += len;
+
+        auto start = r.header.start;
+
+        records[start] = std::move(r);
+    }
+
+    old_records = std::move(records);
+}
+
+//---------------------------------------------------------------------
+ast_unit_t
+parse_cache_t::parse_unit(uint64_t fp)
+{
+    auto &ctx = vpeg::context_data_t::current_ctx;
+
+    size_t start = ctx->get_position();
+
+    size_t column;
+
+    size_t line = ctx->get_line_column(start, &column);
+
+    if (auto it = old_records.find(start);  it != old_records.end())
+    {
+        auto &r = it->second;
+        auto &h = r.header;
+
+        if (h.grammar_fp == fp  &&  h.line == line  &&  h.column == column)
+        {
+            ctx->fill_buffer(h.extent);
+
+            ast_base_t ast;
+
+            if (text_hash(ctx->take_string(start, h.extent)) == h.text_hash  &&
+                v_ast_deserialize(&ast, r.ast.data(), r.ast.size()))
+            {
+                if (auto unit = std::dynamic_pointer_cast<const ast_unit_base_data_t>(ast))
+                {
+                    auto st = ctx->get_state();
+
+                    st.position = h.end;
+
+                    ctx->set_state(st);
+
+                    new_records.push_back(std::move(r));
+
+                    old_records.erase(it);
+
+                    return unit;
+                }
+            }
+        }
+    }
+
+    dirty = true;
+
+    size_t impure = ctx->impure_actions;
+
+    auto unit = parse();
+
+    if (unit  &&  ctx->impure_actions == impure)        //- Side effects can't be replayed...
+    {
+        record_t r;
+
+        auto &h = r.header;
+
+        h.start  = start;
+        h.end    = ctx->get_position();
+        h.extent = ctx->get_buffer_size();      //- The parser looked at [start, extent) at most
+
+        h.line   = line;
+        h.column = column;
+
+        h.text_hash  = text_hash(ctx->take_string(start, h.extent));
+        h.grammar_fp = fp;
+
+        ast_base_t ast = unit;
+
+        if (v_ast_serialize(&r.ast, &ast))  new_records.push_back(std::move(r));
+    }
+
+    return unit;
+}
+
+//---------------------------------------------------------------------
+void
+parse_cache_t::keep_unit(size_t start)
+{
+    if (auto it = old_records.find(start);  it != old_records.end())
+    {
+        new_records.push_back(std::move(it->second));
+
+        old_records.erase(it);
+    }
+    else
+    {
+        dirty = true;
+    }
+}
+
+//---------------------------------------------------------------------
+void
+parse_cache_t::save(void)
+{
+    if (!dirty  &&  old_records.empty())  return;       //- Nothing changed
+
+    {   std::error_code ec;
+
+        fs::create_directories(filepath.parent_path(), ec);
+
+        if (ec)  return;            //- Just a cache...
+    }
+
+    out_binary_t out_binary(filepath);
+
+    const auto &outfs = out_binary.f;
+
+    if (!outfs)  return;
+
+    std::fwrite(ast_magic, sizeof(ast_magic), 1, outfs);
+
+    for (auto &r : new_records)
+    {
+        size_t len = sizeof(header_t) + r.ast.size();
+
+        std::fwrite((char *)&len, sizeof(len), 1, outfs);
+
+        std::fwrite((char *)&r.header, sizeof(header_t), 1, outfs);
+
+        std::fwrite(r.ast.data(), r.ast.size(), 1, outfs);
+    }
+
+    size_t len = 0;
+
+    std::fwrite((char *)&len, sizeof(len), 1, outfs);       //- End of records
+}
@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_PARSE_CACHE_H
+#define VOIDC_PARSE_CACHE_H
+
+#include "voidc_ast.h"
+#include "vpeg_grammar.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+
+//---------------------------------------------------------------------
+//- Hashes: stable across runs...
+//---------------------------------------------------------------------
+uint64_t text_hash(const std::string &text);        //- FNV-1a
+
+uint64_t hash_mix(uint64_t h, uint64_t v);          //- FNV-1a, by bytes
+
+uint64_t binary_identity(const std::filesystem::path &path);       //- Path and stat signature
+
+
+//---------------------------------------------------------------------
+//- Grammar environment
+//---------------------------------------------------------------------
+//- The grammar fingerprint covers names only, not what actions and hooks
+//- actually do. That is defined by voidc itself, by imports and by units
+//- (of the file) which import something or change the grammar. The
+//- environment chains their identities: binaries' identities, units'
+//- text hashes. Unit key: H(fingerprint, environment) - see parse_cache_t
+//- and unit_header_t (voidc_import_binary.h)...
+//---------------------------------------------------------------------
+struct grammar_env_t
+{
+    explicit grammar_env_t(uint64_t voidc_identity);    //- See binary_identity
+
+public:
+    uint64_t unit_key(void) const;
+
+    void begin_unit(void);
+    void end_unit(uint64_t unit_text_hash);
+
+    void add_import(uint64_t identity);
+
+public:
+    static grammar_env_t *current;          //- Of the file being compiled, if any
+
+private:
+    uint64_t key;
+
+    vpeg::grammar_t grammar;        //- At the unit's start
+
+    uint64_t imports  = 0;
+    bool     imported = false;
+};
+
+
+//---------------------------------------------------------------------
+//- Parsed units cache
+//---------------------------------------------------------------------
+//- File: <binary>.ast - magic, then records: size_t len (0 - end),
+//- then len bytes: record header + serialized AST (the rest).
+//- A unit is taken from the cache if it starts at the same position (and
+//- line/column - they go to the AST), has the same key (see grammar_env_t)
+//- and the text [start, extent), i.e. all the parser looked at, has the
+//- same hash. Units which called impure grammar actions (see
+//- grammar_data_t::is_action_pure) are not cached at all...
+//---------------------------------------------------------------------
+struct parse_cache_t
+{
+    typedef ast_unit_t (*parse_fun_t)(void);
+
+    parse_cache_t(const std::filesystem::path &filepath, parse_fun_t parse);
+
+public:
+    ast_unit_t parse_unit(uint64_t key);    //- See grammar_env_t::unit_key
+
+    void keep_unit(size_t start);           //- Unit replayed, not parsed
+
+    void save(void);
+
+private:
+    struct header_t
+    {
+        size_t start;
+        size_t end;
+        size_t extent;
+
+        size_t line;                //- Of the start
+        size_t column;
+
+        uint64_t text_hash;
+        uint64_t grammar_fp;        //- Unit key, in fact
+    };
+
+    struct record_t
+    {
+        header_t    header;
+        std::string ast;
+    };
+
+private:
+    const std::filesystem::path filepath;
+
+    const parse_fun_t parse;
+
+    std::map<size_t, record_t> old_records;         //- By start position
+    std::vector<record_t>      new_records;
+
+    bool dirty = false;
+
+private:
+    void load(void);
+};
+
+
+#endif  //- VOIDC_PARSE_CACHE_H
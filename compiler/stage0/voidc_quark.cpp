@@ -5,22 +5,463 @@
 #include "voidc_quark.h"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <cassert>
 
-#include <unordered_map>
-#include <unordered_set>
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <string_view>
+#include <functional>
 
-#include <immer/vector_transient.hpp>
 
+//---------------------------------------------------------------------
+//- Interned string entry (arena-allocated, never moves, never dies)
+//---------------------------------------------------------------------
+namespace
+{
+
+struct entry_t
+{
+    size_t    hash;
+    size_t    size;
+    v_quark_t quark;            //- Sic! See v_quark_ptr_from_string...
+
+    char chars[1];              //- Actually, size+1 (with '\0')
+};
+
+
+//---------------------------------------------------------------------
+//- Open addressing table (one per shard)
+//---------------------------------------------------------------------
+//- Readers never lock: they just acquire-load the current table and
+//- probe its slots. Writers (under the shard mutex) either fill an empty
+//- slot or publish a bigger copy of the table. Old tables are retired
+//- but never freed - a concurrent reader may still be probing them...
+//---------------------------------------------------------------------
+struct table_t
+{
+    table_t *retired;           //- Previous (smaller) table
+
+    size_t mask;
+
+    std::atomic<entry_t *> slots[1];        //- Actually, mask+1
+};
+
+//---------------------------------------------------------------------
+struct shard_t
+{
+    std::mutex mutex;
+
+    std::atomic<table_t *> table = nullptr;
+
+    size_t count = 0;           //- Under mutex
+
+    char *arena_cur = nullptr;  //- Under mutex
+    char *arena_end = nullptr;  //- ...
+};
+
+
+//---------------------------------------------------------------------
+constexpr unsigned shard_bits  = 4;
+constexpr size_t   shard_count = size_t(1) << shard_bits;
+
+constexpr size_t initial_table_size = 256;
+
+constexpr size_t arena_block_size = 64*1024;
+
+//---------------------------------------------------------------------
+//- Quark -> entry: geometric chunks, chunk k has (first_chunk_size << k) slots
+//---------------------------------------------------------------------
+constexpr unsigned first_chunk_bits = 10;
+constexpr size_t   first_chunk_size = size_t(1) << first_chunk_bits;
+
+constexpr unsigned chunk_count = 33 - first_chunk_bits;     //- Enough for any v_quark_t
+
+
+//---------------------------------------------------------------------
+//- Globals (constant-initialized: usable from any static constructor)
+//---------------------------------------------------------------------
+shard_t voidc_quark_shards[shard_count];
+
+std::atomic<entry_t **> voidc_quark_chunks[chunk_count];
+
+std::atomic<v_quark_t> voidc_quark_next = 0;        //- Last allocated id
+std::atomic<v_quark_t> voidc_quark_last = 0;        //- Last published id
+
+
+//---------------------------------------------------------------------
+//- Helpers
+//---------------------------------------------------------------------
+inline size_t
+hash_string(const char *str, size_t len)
+{
+    return  std::hash<std::string_view>{}(std::string_view(str, len));
+}
+
+//---------------------------------------------------------------------
+inline shard_t &
+shard_of(size_t hash)
+{
+    return  voidc_quark_shards[hash & (shard_count-1)];
+}
+
+inline size_t
+probe_start(size_t hash)
+{
+    return  hash >> shard_bits;
+}
 
 //---------------------------------------------------------------------
-//- Globals
+inline bool
+entry_matches(const entry_t *e, size_t hash, const char *str, size_t len)
+{
+    return  e->hash == hash  &&
+            e->size == len   &&
+            std::memcmp(e->chars, str, len) == 0;
+}
+
+//---------------------------------------------------------------------
+entry_t *
+table_find(const table_t *tab, size_t hash, const char *str, size_t len)
+{
+    if (!tab) return nullptr;
+
+    auto mask = tab->mask;
+
+    for (size_t i = probe_start(hash) & mask; ; i = (i+1) & mask)
+    {
+        auto e = tab->slots[i].load(std::memory_order_acquire);
+
+        if (!e) return nullptr;
+
+        if (entry_matches(e, hash, str, len)) return e;
+    }
+}
+
 //---------------------------------------------------------------------
-static std::unordered_set<std::string> voidc_interned_strings;
+void
+table_put(table_t *tab, entry_t *e)
+{
+    auto mask = tab->mask;
+
+    for (size_t i = probe_start(e->hash) & mask; ; i = (i+1) & mask)
+    {
+        auto &slot = tab->slots[i];
 
-static std::unordered_map<const char *, const v_quark_t> voidc_quark_from_string;
+        if (!slot.load(std::memory_order_relaxed))
+        {
+            slot.store(e, std::memory_order_release);
 
-static immer::vector_transient<const std::string *> voidc_quark_to_std_string;
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+table_t *
+table_make(size_t size, table_t *retired)
+{
+    assert((size & (size-1)) == 0);
+
+    auto mem = std::malloc(sizeof(table_t) + (size-1)*sizeof(std::atomic<entry_t *>));
+
+    if (!mem) throw std::bad_alloc();
+
+    auto tab = static_cast<table_t *>(mem);
+
+    tab->retired = retired;
+    tab->mask    = size - 1;
+
+    for (size_t i=0; i<size; ++i)
+    {
+        new(&tab->slots[i]) std::atomic<entry_t *>(nullptr);
+    }
+
+    return tab;
+}
+
+//---------------------------------------------------------------------
+entry_t *
+arena_alloc_entry(shard_t &sh, size_t len)
+{
+    size_t sz = offsetof(entry_t, chars) + len + 1;
+
+    constexpr size_t align = alignof(entry_t);
+
+    sz = (sz + align - 1) & ~(align - 1);
+
+    if (size_t(sh.arena_end - sh.arena_cur) < sz)
+    {
+        size_t bsz = (sz > arena_block_size/4 ? sz : arena_block_size);
+
+        auto blk = static_cast<char *>(std::malloc(bsz));
+
+        if (!blk) throw std::bad_alloc();
+
+        if (bsz == arena_block_size)        //- Else, keep the current block
+        {
+            sh.arena_cur = blk;
+            sh.arena_end = blk + bsz;
+        }
+        else
+        {
+            return static_cast<entry_t *>(static_cast<void *>(blk));
+        }
+    }
+
+    auto e = static_cast<entry_t *>(static_cast<void *>(sh.arena_cur));
+
+    sh.arena_cur += sz;
+
+    return e;
+}
+
+
+//---------------------------------------------------------------------
+inline void
+quark_locate(v_quark_t vq, unsigned &k, size_t &off)
+{
+    size_t n = size_t(vq - 1) + first_chunk_size;
+
+    unsigned top = 63 - unsigned(__builtin_clzll((unsigned long long)n));
+
+    k   = top - first_chunk_bits;
+    off = n - (first_chunk_size << k);
+}
+
+//---------------------------------------------------------------------
+void
+quark_store(v_quark_t vq, entry_t *e)
+{
+    unsigned k;
+    size_t off;
+
+    quark_locate(vq, k, off);
+
+    auto &chunk = voidc_quark_chunks[k];
+
+    auto c = chunk.load(std::memory_order_acquire);
+
+    if (!c)
+    {
+        auto nc = static_cast<entry_t **>(std::calloc(first_chunk_size << k, sizeof(entry_t *)));
+
+        if (!nc) throw std::bad_alloc();
+
+        if (chunk.compare_exchange_strong(c, nc, std::memory_order_acq_rel))  c = nc;
+        else                                                                  std::free(nc);
+    }
+
+    c[off] = e;         //- Published later via the shard table (release)
+}
+
+//---------------------------------------------------------------------
+void intern_static_quarks(void);
+
+std::once_flag voidc_quark_static_once;
+
+//---------------------------------------------------------------------
+inline const entry_t *
+quark_entry(v_quark_t vq)
+{
+    unsigned k;
+    size_t off;
+
+    quark_locate(vq, k, off);
+
+    auto c = voidc_quark_chunks[k].load(std::memory_order_acquire);
+
+    if (!c)         //- Static quark used before any interning?
+    {
+        std::call_once(voidc_quark_static_once, intern_static_quarks);
+
+        c = voidc_quark_chunks[k].load(std::memory_order_acquire);
+    }
+
+    return  c[off];
+}
+
+
+//---------------------------------------------------------------------
+//- Lookup / intern
+//---------------------------------------------------------------------
+inline entry_t *
+lookup_entry(const char *str, size_t len, size_t hash)
+{
+    auto &sh = shard_of(hash);
+
+    auto tab = sh.table.load(std::memory_order_acquire);
+
+    if (!tab)       //- Very first lookup: intern static quarks
+    {
+        std::call_once(voidc_quark_static_once, intern_static_quarks);
+
+        tab = sh.table.load(std::memory_order_acquire);
+    }
+
+    return  table_find(tab, hash, str, len);
+}
+
+//---------------------------------------------------------------------
+entry_t *
+intern_entry(const char *str, size_t len)
+{
+    auto hash = hash_string(str, len);
+
+    if (auto e = lookup_entry(str, len, hash))  return e;      //- Lock-free path
+
+    auto &sh = shard_of(hash);
+
+    std::lock_guard<std::mutex> lock(sh.mutex);
+
+    auto tab = sh.table.load(std::memory_order_relaxed);
+
+    if (auto e = table_find(tab, hash, str, len)) return e;    //- Somebody was faster...
+
+    auto e = arena_alloc_entry(sh, len);
+
+    e->hash  = hash;
+    e->size  = len;
+    e->quark = voidc_quark_next.fetch_add(1, std::memory_order_relaxed) + 1;      //- Sic!
+
+    std::memcpy(e->chars, str, len);
+
+    e->chars[len] = '\0';
+
+    quark_store(e->quark, e);
+
+    if (!tab  ||  2*(sh.count + 1) > tab->mask + 1)
+    {
+        auto ntab = table_make(tab ? 2*(tab->mask + 1) : initial_table_size, tab);
+
+        if (tab)
+        {
+            for (size_t i=0; i<=tab->mask; ++i)
+            {
+                if (auto o = tab->slots[i].load(std::memory_order_relaxed))  table_put(ntab, o);
+            }
+        }
+
+        table_put(ntab, e);
+
+        sh.table.store(ntab, std::memory_order_release);
+    }
+    else
+    {
+        table_put(tab, e);
+    }
+
+    sh.count += 1;
+
+    //- Entry is published - now advance the last id, in order (other
+    //- shards may have allocated ids below ours and still be publishing)...
+
+    for (auto prev = e->quark - 1; voidc_quark_last.load(std::memory_order_acquire) != prev; )
+    {
+        std::this_thread::yield();
+    }
+
+    voidc_quark_last.store(e->quark, std::memory_order_release);
+
+    return e;
+}
+
+
+//---------------------------------------------------------------------
+//- Static quarks (see voidc_quark_table.h)
+//---------------------------------------------------------------------
+struct static_string_t
+{
+    const char *str;
+    size_t      len;
+};
+
+constexpr static_string_t voidc_static_strings[] =
+{
+#define DEF(id, str) { str, sizeof(str)-1 },
+
+    VOIDC_STATIC_QUARKS(DEF)
+
+#undef DEF
+};
+
+constexpr size_t static_count = v_static_quark_next - 1;
+
+static_assert(sizeof(voidc_static_strings)/sizeof(voidc_static_strings[0]) == static_count);
+
+//---------------------------------------------------------------------
+//- One batch: every shard table is presized so that the whole set goes
+//- in without rehashing, and only then tables get published. Concurrent
+//- lookups meanwhile see "no table" and wait on the once_flag...
+//---------------------------------------------------------------------
+void
+intern_static_quarks(void)
+{
+    size_t hashes[static_count];
+
+    size_t per_shard[shard_count] = {};
+
+    for (size_t i=0; i<static_count; ++i)
+    {
+        auto &ss = voidc_static_strings[i];
+
+        hashes[i] = hash_string(ss.str, ss.len);
+
+        per_shard[hashes[i] & (shard_count-1)] += 1;
+    }
+
+    table_t *tables[shard_count];
+
+    for (size_t k=0; k<shard_count; ++k)
+    {
+        size_t size = initial_table_size;
+
+        while (2*(per_shard[k] + 1) > size) size *= 2;
+
+        tables[k] = table_make(size, nullptr);
+    }
+
+    for (size_t i=0; i<static_count; ++i)
+    {
+        auto &ss = voidc_static_strings[i];
+
+        auto hash = hashes[i];
+
+        auto k = hash & (shard_count-1);
+
+        auto &sh = voidc_quark_shards[k];
+
+        assert(!table_find(tables[k], hash, ss.str, ss.len) && "Duplicate static quark!");
+
+        auto e = arena_alloc_entry(sh, ss.len);
+
+        e->hash  = hash;
+        e->size  = ss.len;
+        e->quark = v_quark_t(i + 1);        //- Sic!
+
+        std::memcpy(e->chars, ss.str, ss.len + 1);
+
+        quark_store(e->quark, e);
+
+        table_put(tables[k], e);
+
+        sh.count += 1;
+    }
+
+    voidc_quark_next.store(v_quark_t(static_count), std::memory_order_relaxed);
+
+    for (size_t k=0; k<shard_count; ++k)
+    {
+        voidc_quark_shards[k].table.store(tables[k], std::memory_order_release);
+    }
+
+    voidc_quark_last.store(v_quark_t(static_count), std::memory_order_release);
+}
+
+}   //- namespace
 
 
 //---------------------------------------------------------------------
@@ -36,9 +477,7 @@ v_quark_ptr_from_string(const char *str)
         return &zero;
     }
 
-    if (v_intern_try_string(str))   return &voidc_quark_from_string[str];
-
-    return &voidc_quark_from_string[v_intern_string(str)];
+    return &intern_entry(str, std::strlen(str))->quark;
 }
 
 //---------------------------------------------------------------------
@@ -48,6 +487,15 @@ v_quark_from_string(const char *str)
     return *v_quark_ptr_from_string(str);
 }
 
+//---------------------------------------------------------------------
+v_quark_t
+v_quark_from_string_n(const char *str, size_t len)
+{
+    if (str == nullptr) return 0;
+
+    return  intern_entry(str, len)->quark;
+}
+
 
 //---------------------------------------------------------------------
 const char *
@@ -55,7 +503,7 @@ v_quark_to_string(v_quark_t vq)
 {
     if (vq == 0)  return nullptr;
 
-    return  voidc_quark_to_std_string[vq-1]->c_str();       //- Sic!
+    return  quark_entry(vq)->chars;
 }
 
 
@@ -65,7 +513,35 @@ v_quark_to_string_size(v_quark_t vq)
 {
     if (vq == 0)  return 0;
 
-    return  voidc_quark_to_std_string[vq-1]->size();        //- Sic!
+    return  quark_entry(vq)->size;
+}
+
+//---------------------------------------------------------------------
+const char *
+v_quark_to_string_view(v_quark_t vq, size_t *size)
+{
+    if (vq == 0)
+    {
+        if (size) *size = 0;
+
+        return nullptr;
+    }
+
+    auto e = quark_entry(vq);
+
+    if (size) *size = e->size;
+
+    return e->chars;
+}
+
+
+//---------------------------------------------------------------------
+v_quark_t
+v_quark_last(void)
+{
+    std::call_once(voidc_quark_static_once, intern_static_quarks);
+
+    return  voidc_quark_last.load(std::memory_order_acquire);
 }
 
 
@@ -77,15 +553,11 @@ v_quark_try_string(const char *str)
 {
     if (str == nullptr) return 0;
 
-    if (v_intern_try_string(str))   return voidc_quark_from_string[str];
-
-    auto it = voidc_interned_strings.find(str);
+    auto len = std::strlen(str);
 
-    if (it == voidc_interned_strings.end()) return 0;
+    auto e = lookup_entry(str, len, hash_string(str, len));
 
-    auto it_str = it->c_str();
-
-    return voidc_quark_from_string[it_str];
+    return  (e ? e->quark : 0);
 }
 
 //---------------------------------------------------------------------
@@ -94,20 +566,7 @@ v_intern_string(const char *str)
 {
     if (str == nullptr) return nullptr;
 
-    auto [it, ok] = voidc_interned_strings.insert(str);
-
-    auto it_str = it->c_str();
-
-    if (ok)
-    {
-        auto q = v_quark_t(voidc_quark_from_string.size() + 1);     //- Sic!
-
-        voidc_quark_from_string.insert({it_str, q});
-
-        voidc_quark_to_std_string.push_back(&*it);
-    }
-
-    return it_str;
+    return  intern_entry(str, std::strlen(str))->chars;
 }
 
 //---------------------------------------------------------------------
@@ -116,11 +575,11 @@ v_intern_try_string(const char *str)
 {
     if (str == nullptr) return nullptr;
 
-    auto it = voidc_quark_from_string.find(str);
+    auto len = std::strlen(str);
 
-    if (it == voidc_quark_from_string.end())  return nullptr;
-
-    return str;     //- Sic!
-}
+    auto e = lookup_entry(str, len, hash_string(str, len));
 
+    if (e  &&  e->chars == str) return str;     //- Sic!
 
+    return nullptr;
+}
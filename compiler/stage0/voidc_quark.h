@@ -6,6 +6,7 @@
 #define VOIDC_QUARK_H
 
 #include "voidc_dllexport.h"
+#include "voidc_quark_table.h"
 
 #include <cstdint>
 #include <cstddef>
@@ -24,11 +25,17 @@ const v_quark_t *v_quark_ptr_from_string(const char *str);
 
 v_quark_t v_quark_from_string(const char *str);
 
+v_quark_t v_quark_from_string_n(const char *str, size_t len);      //- No strlen...
+
 const char *v_quark_to_string(v_quark_t vq);
 
 
 size_t v_quark_to_string_size(v_quark_t vq);
 
+const char *v_quark_to_string_view(v_quark_t vq, size_t *size);     //- Both at once
+
+v_quark_t v_quark_last(void);           //- Last published (all values up to it are valid quarks)
+
 
 v_quark_t v_quark_try_string(const char *str);
 
@@ -43,4 +50,21 @@ VOIDC_DLLEXPORT_END
 }   //- extern "C"
 
 
+//---------------------------------------------------------------------
+//- Well-known quarks: constexpr ids (see voidc_quark_table.h)
+//---------------------------------------------------------------------
+enum v_static_quark_t : v_quark_t
+{
+    v_static_quark_null = 0,
+
+#define DEF(id, str) v_static_quark_##id,
+
+    VOIDC_STATIC_QUARKS(DEF)
+
+#undef DEF
+
+    v_static_quark_next         //- First "dynamic" quark
+};
+
+
 #endif  //- VOIDC_QUARK_H
@@ -0,0 +1,126 @@
+//---------------------------------------------------------------------
+//- Copyright (C) 2020-2025 Dmitry Borodkin <borodkin.dn@gmail.com>
+//- SDPX-License-Identifier: LGPL-3.0-or-later
+//---------------------------------------------------------------------
+#ifndef VOIDC_QUARK_TABLE_H
+#define VOIDC_QUARK_TABLE_H
+
+
+//---------------------------------------------------------------------
+//- Well-known quarks (interned first, in this very order)
+//---------------------------------------------------------------------
+//- DEF(id, string) -> constexpr v_static_quark_<id> == <position>+1
+//-
+//- Strings must be unique!  Append only - ids are baked into binaries.
+//- Any change shifts dynamic ids too: bump the import binary magic (see
+//- static_assert in voidc_import_binary.cpp).
+//---------------------------------------------------------------------
+#define VOIDC_STATIC_QUARKS(DEF) \
+    /*- AST tags -*/ \
+    DEF(stmt_list,          "stmt_list") \
+    DEF(expr_list,          "expr_list") \
+    DEF(unit,               "unit") \
+    DEF(stmt,               "stmt") \
+    DEF(expr_call,          "expr_call") \
+    DEF(expr_identifier,    "expr_identifier") \
+    DEF(expr_integer,       "expr_integer") \
+    DEF(expr_string,        "expr_string") \
+    DEF(expr_char,          "expr_char") \
+    DEF(expr_compiled,      "expr_compiled") \
+    /*- AST properties -*/ \
+    DEF(pos_start,          "pos_start") \
+    DEF(pos_end,            "pos_end") \
+    /*- Grammar (level 0) -*/ \
+    DEF(stmt_list_lr,       "stmt_list_lr") \
+    DEF(expr,               "expr") \
+    DEF(expr_list_lr,       "expr_list_lr") \
+    DEF(prim,               "prim") \
+    DEF(identifier,         "identifier") \
+    DEF(ident_start,        "ident_start") \
+    DEF(ident_cont,         "ident_cont") \
+    DEF(integer,            "integer") \
+    DEF(dec_natural,        "dec_natural") \
+    DEF(dec_positive,       "dec_positive") \
+    DEF(dec_digit,          "dec_digit") \
+    DEF(string,             "string") \
+    DEF(char,               "char") \
+    DEF(str_body,           "str_body") \
+    DEF(str_char,           "str_char") \
+    DEF(esc_sequence,       "esc_sequence") \
+    DEF(_,                  "_") \
+    DEF(comment,            "comment") \
+    DEF(shebang,            "shebang") \
+    DEF(space,              "space") \
+    DEF(EOL,                "EOL") \
+    /*- Grammar actions (level 0) -*/ \
+    DEF(mk_unit,            "mk_unit") \
+    DEF(mk_stmt_list,       "mk_stmt_list") \
+    DEF(mk_stmt,            "mk_stmt") \
+    DEF(mk_expr_call,       "mk_expr_call") \
+    DEF(mk_expr_list,       "mk_expr_list") \
+    DEF(mk_expr_identifier, "mk_expr_identifier") \
+    DEF(mk_expr_integer,    "mk_expr_integer") \
+    DEF(mk_expr_string,     "mk_expr_string") \
+    DEF(mk_expr_char,       "mk_expr_char") \
+    DEF(mk_pos_integer,     "mk_pos_integer") \
+    DEF(mk_neg_integer,     "mk_neg_integer") \
+    DEF(mk_dec_integer,     "mk_dec_integer") \
+    DEF(mk_dec_numdigit,    "mk_dec_numdigit") \
+    DEF(mk_string_str,      "mk_string_str") \
+    DEF(mk_string_chr,      "mk_string_chr") \
+    DEF(mk_EOF,             "mk_EOF") \
+    DEF(is_SOF,             "is_SOF") \
+    /*- Basic types -*/ \
+    DEF(void,               "void") \
+    DEF(bool,               "bool") \
+    DEF(short,              "short") \
+    DEF(int,                "int") \
+    DEF(unsigned,           "unsigned") \
+    DEF(long,               "long") \
+    DEF(long_long,          "long_long") \
+    DEF(intptr_t,           "intptr_t") \
+    DEF(size_t,             "size_t") \
+    DEF(char32_t,           "char32_t") \
+    DEF(uint64_t,           "uint64_t") \
+    DEF(false,              "false") \
+    DEF(true,               "true") \
+    DEF(v_static_type_t,    "v_static_type_t") \
+    DEF(v_type_t,           "v_type_t") \
+    DEF(v_type_ptr,         "v_type_ptr") \
+    DEF(v_quark_t,          "v_quark_t") \
+    /*- Hooks, dictionaries, constants... -*/ \
+    DEF(voidc_typenames_dict,                   "voidc.typenames_dict") \
+    DEF(voidc_hook_obtain_alias,                "voidc.hook_obtain_alias") \
+    DEF(voidc_hook_lookup_alias,                "voidc.hook_lookup_alias") \
+    DEF(voidc_hook_obtain_module,               "voidc.hook_obtain_module") \
+    DEF(voidc_hook_finish_module,               "voidc.hook_finish_module") \
+    DEF(voidc_hook_try_to_adopt,                "voidc.hook_try_to_adopt") \
+    DEF(voidc_hook_try_to_convert,              "voidc.hook_try_to_convert") \
+    DEF(voidc_hook_make_temporary,              "voidc.hook_make_temporary") \
+    DEF(voidc_hook_lookup_overload,             "voidc.hook_lookup_overload") \
+    DEF(voidc_internal_function_type,           "voidc.internal_function_type") \
+    DEF(voidc_internal_return_value,            "voidc.internal_return_value") \
+    DEF(voidc_internal_branch_target_leave,     "voidc.internal_branch_target_leave") \
+    DEF(voidc_import_bin_filename_prefix,       "voidc.import_bin_filename_prefix") \
+    DEF(voidc_import_bin_filename_suffix,       "voidc.import_bin_filename_suffix") \
+    DEF(voidc_import_bin_filename_rewrite,      "voidc.import_bin_filename_rewrite") \
+    DEF(voidc_object_file_load_to_jit_internal_helper, "voidc_object_file_load_to_jit_internal_helper") \
+    /*- Grammar (level 0): list builders -*/ \
+    DEF(stmt_list_tr,        "stmt_list_tr") \
+    DEF(expr_list_tr,        "expr_list_tr") \
+    DEF(mk_list_builder,     "mk_list_builder") \
+    DEF(mk_stmt_list_freeze, "mk_stmt_list_freeze") \
+    DEF(mk_expr_list_freeze, "mk_expr_list_freeze") \
+    /*- Optimization policy -*/ \
+    DEF(voidc_opt_level_unit_action, "voidc.opt_level_unit_action") \
+    DEF(voidc_opt_level_module,      "voidc.opt_level_module") \
+    /*- Import cache -*/ \
+    DEF(voidc_import_cache_dir,      "voidc.import_cache_dir") \
+    /*- Import binaries -*/ \
+    DEF(voidc_object_file_load_to_jit_record_helper, "voidc_object_file_load_to_jit_record_helper") \
+    DEF(voidc_import_compression,    "voidc.import_compression") \
+    /*- Partitioned modules -*/ \
+    DEF(voidc_object_file_load_to_jit_group_helper,  "voidc_object_file_load_to_jit_group_helper")
+
+
+#endif  //- VOIDC_QUARK_TABLE_H
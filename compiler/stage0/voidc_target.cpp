@@ -6,17 +6,36 @@
 
 #include <stdexcept>
 #include <cassert>
+#include <thread>
 
 #include <llvm-c/Target.h>
 #include <llvm-c/TargetMachine.h>
 #include <llvm-c/Analysis.h>
 #include <llvm-c/Object.h>
-#include <llvm-c/Transforms/PassBuilder.h>
-
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/Orc/DebugObjectManagerPlugin.h>
+#include <llvm/ExecutionEngine/Orc/EPCDebugObjectRegistrar.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Object/SymbolSize.h>
 #include <llvm/Support/CBindingWrapping.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 
 #include "voidc_compiler.h"
+#include "voidc_interp.h"
+#include "voidc_jit_events.h"
+#include "voidc_compile_pipeline.h"
+#include "voidc_lazy_layer.h"
 
 
 //---------------------------------------------------------------------
@@ -1449,12 +1468,51 @@ v_make_temporary_default(void *void_ctx, v_type_t *type, LLVMValueRef value)
 }
 
 
+//---------------------------------------------------------------------
+//- Unit actions' JITDylibs pool
+//---------------------------------------------------------------------
+//- Creating/removing a JITDylib for every unit is costly, so they are
+//- reused: each unit gets its own resource tracker, removed after run.
+//- Nested units (imports in actions) take another dylib from the pool.
+//- Link order is recomputed only when it may be stale, i.e. after any
+//- change of some deque_jd (see link_order_stamp)...
+//---------------------------------------------------------------------
+struct unit_jd_t
+{
+    LLVMOrcJITDylibRef jd;
+
+    const void *ctx;            //- Link order set up for this one...
+    size_t      stamp;          //- ... at this stamp
+};
+
+static std::vector<unit_jd_t> unit_jd_pool;     //- Free ones
+
+static size_t link_order_stamp = 1;
+
+static void
+unit_jd_pool_invalidate(void)
+{
+    link_order_stamp += 1;
+
+    //- Link orders may refer to dylibs being removed...
+
+    for (auto &it : unit_jd_pool)
+    {
+        unwrap(it.jd)->setLinkOrder({}, false);
+
+        it.ctx = nullptr;
+    }
+}
+
+
 //---------------------------------------------------------------------
 //- Voidc template Context
 //---------------------------------------------------------------------
 template<typename T, typename... TArgs>
 voidc_template_ctx_t<T, TArgs...>::~voidc_template_ctx_t()
 {
+    unit_jd_pool_invalidate();
+
     auto &es = unwrap(voidc_global_ctx_t::jit)->getExecutionSession();
 
     for (auto jd : deque_jd)
@@ -1479,6 +1537,20 @@ voidc_template_ctx_t<T, TArgs...>::add_symbol_value(v_quark_t raw_name_q, void *
     unit_symbols[vjit->mangleAndIntern(raw_name)] = { ExecutorAddr::fromPtr(value), JITSymbolFlags::Exported };
 }
 
+//---------------------------------------------------------------------
+//- SymbolMap values: JITEvaluatedSymbol (LLVM < 17) or ExecutorSymbolDef
+//---------------------------------------------------------------------
+template<typename S>
+static inline void *
+symbol_def_address(const S &sym)
+{
+#if LLVM_VERSION_MAJOR < 17
+    return  jitTargetAddressToPointer<void *>(sym.getAddress());
+#else
+    return  sym.getAddress().template toPtr<void *>();
+#endif
+}
+
 //---------------------------------------------------------------------
 template<typename T, typename... Targs>
 static inline
@@ -1489,6 +1561,21 @@ flush_unit_symbols_helper(voidc_template_ctx_t<T, Targs...> *ctx)
 
     auto err = unwrap(ctx->base_jd)->define(absoluteSymbols(ctx->unit_symbols));
 
+    //- base_jd is the last one in the search order: never shadows...
+
+    char prefix = LLVMOrcLLJITGetGlobalPrefix(voidc_global_ctx_t::jit);
+
+    for (auto &it : ctx->unit_symbols)
+    {
+        auto name = *it.first;
+
+        if (prefix  &&  !name.empty()  &&  name[0] == prefix)  name = name.drop_front();
+
+        auto q = v_quark_from_string_n(name.data(), name.size());
+
+        ctx->symbol_index.insert({q, {ctx->base_jd, symbol_def_address(it.second)}});
+    }
+
     ctx->unit_symbols.clear();
 }
 
@@ -1537,10 +1624,12 @@ voidc_global_template_ctx_t::setup_link_order(LLVMOrcJITDylibRef jd)
 
     if (local_ctx)  set_item(static_cast<voidc_local_ctx_t *>(local_ctx)->base_jd);
 
-    for (auto _jd : deque_jd)   set_item(_jd);
+    for (auto _jd : deque_jd)   if (_jd != jd)  set_item(_jd);     //- Objects' dylib is there...
 
     set_item(base_jd, JITDylibLookupFlags::MatchAllSymbols);
 
+    so.resize(it - so.begin());
+
     unwrap(jd)->setLinkOrder(so, false);        //- Set "as is"
 }
 
@@ -1570,16 +1659,97 @@ voidc_local_template_ctx_t::setup_link_order(LLVMOrcJITDylibRef jd)
 
     set_item(jd);
 
-    for (auto _jd : deque_jd)   set_item(_jd);
+    for (auto _jd : deque_jd)   if (_jd != jd)  set_item(_jd);     //- Objects' dylib is there...
 
     for (auto _jd : vctx.deque_jd)  set_item(_jd);
 
     set_item(vctx.base_jd, JITDylibLookupFlags::MatchAllSymbols);
 
+    so.resize(it - so.begin());
+
     unwrap(jd)->setLinkOrder(so, false);        //- Set "as is"
 }
 
 
+//---------------------------------------------------------------------
+template<typename F>
+static void
+for_each_defined_symbol(LLVMMemoryBufferRef membuf, F fun)      //- Global ones, "as is" (i.e. mangled)
+{
+    auto obj = object::ObjectFile::createObjectFile(unwrap(membuf)->getMemBufferRef());
+
+    if (!obj)
+    {
+        consumeError(obj.takeError());
+
+        return;
+    }
+
+    for (auto &sym : (*obj)->symbols())
+    {
+        auto flags = sym.getFlags();
+
+        if (!flags)
+        {
+            consumeError(flags.takeError());
+
+            continue;
+        }
+
+        if ((*flags & object::SymbolRef::SF_Undefined)  ||  !(*flags & object::SymbolRef::SF_Global))  continue;
+
+        auto name = sym.getName();
+
+        if (!name)
+        {
+            consumeError(name.takeError());
+
+            continue;
+        }
+
+        fun(*name);
+    }
+}
+
+//---------------------------------------------------------------------
+static inline bool
+name_starts_with(StringRef name, StringRef prefix)
+{
+#if LLVM_VERSION_MAJOR < 16
+    return  name.startswith(prefix);
+#else
+    return  name.starts_with(prefix);
+#endif
+}
+
+static StringRef
+demangle_symbol_name(StringRef name)
+{
+    char prefix = LLVMOrcLLJITGetGlobalPrefix(voidc_global_ctx_t::jit);
+
+    if (prefix  &&  !name.empty()  &&  name[0] == prefix)  name = name.drop_front();
+
+    return name;
+}
+
+//---------------------------------------------------------------------
+static void
+notify_jit_code_load(StringRef sname, uint64_t addr, uint64_t size)
+{
+    //- Unit actions are already "voidc.unit_action_<line>_<column>"...
+
+    std::string name = demangle_symbol_name(sname).str();
+
+    auto &vctx = *voidc_global_ctx_t::voidc;
+
+    if (vctx.local_ctx  &&  !vctx.local_ctx->filename.empty())
+    {
+        name += " [" + vctx.local_ctx->filename + "]";
+    }
+
+    voidc_jit_events_code_load(name.c_str(), addr, size);
+}
+
 //---------------------------------------------------------------------
 struct search_request_t
 {
@@ -1590,76 +1760,188 @@ struct search_request_t
 };
 
 //---------------------------------------------------------------------
-static void
-add_object_file_to_jd_with_rt(LLVMMemoryBufferRef membuf,
-                              LLVMOrcJITDylibRef jd,
-                              LLVMOrcResourceTrackerRef rt,
-                              search_request_t *req)
+//- Object goes to the JIT without copying: it is materialized by the
+//- lookup, so membuf must stay alive till then. Only the requested
+//- symbols are looked up, all at once. For the index, defined names are
+//- just recorded (with the dylib) - see find_symbol_value...
+//---------------------------------------------------------------------
+struct object_lookup_t
 {
-    char *msg = nullptr;
+    SymbolLookupSet lookup_set;
+
+    std::vector<StringRef> index_names;     //- Point into membuf!
+};
 
+static bool
+add_object_file_to_rt(LLVMMemoryBufferRef membuf,
+                      LLVMOrcResourceTrackerRef rt,
+                      const search_request_t *req,
+                      bool index,
+                      object_lookup_t &ol)
+{
     auto &jit = voidc_global_ctx_t::jit;
 
+    auto &es = unwrap(jit)->getExecutionSession();
+
     //-------------------------------------------------------------
-    auto bref = LLVMCreateBinary(membuf, nullptr, &msg);
-    assert(bref);
+    StringRef first_name;
 
-    auto mb_copy = LLVMBinaryCopyMemoryBuffer(bref);
+    for_each_defined_symbol(membuf, [&](StringRef name)
+    {
+        bool wanted = false;
+
+        for (int i=0; !wanted && req && req[i].prefix; ++i)
+        {
+            wanted = name_starts_with(name, StringRef(req[i].prefix, req[i].length));
+        }
+
+        if (wanted)  ol.lookup_set.add(es.intern(name), SymbolLookupFlags::WeaklyReferencedSymbol);
+
+        if (index)  ol.index_names.push_back(name);
+
+        if (first_name.empty())  first_name = name;
+    });
+
+    if (ol.lookup_set.empty()  &&  !first_name.empty())
+    {
+        ol.lookup_set.add(es.intern(first_name), SymbolLookupFlags::WeaklyReferencedSymbol);      //- Just to materialize...
+    }
 
     //-------------------------------------------------------------
-    auto lerr = LLVMOrcLLJITAddObjectFileWithRT(jit, rt, mb_copy);
+    auto mb_ref = LLVMCreateMemoryBufferWithMemoryRange(LLVMGetBufferStart(membuf),
+                                                        LLVMGetBufferSize(membuf),
+                                                        "voidc_object",
+                                                        false);
+
+    auto lerr = LLVMOrcLLJITAddObjectFileWithRT(jit, rt, mb_ref);
 
     if (lerr)
     {
-        msg = LLVMGetErrorMessage(lerr);
+        auto msg = LLVMGetErrorMessage(lerr);
 
         printf("\n%s\n", msg);
 
         LLVMDisposeErrorMessage(msg);
-    }
 
-    //-------------------------------------------------------------
-    LLVMOrcJITTargetAddress ret = 0;
+        return false;
+    }
 
-    auto it = LLVMObjectFileCopySymbolIterator(bref);
+    return true;
+}
 
-    while(!LLVMObjectFileIsSymbolIteratorAtEnd(bref, it))
+static void
+lookup_object_file_symbols(LLVMOrcJITDylibRef jd,
+                           object_lookup_t &ol,
+                           search_request_t *req,
+                           voidc_symbol_index_t *index = nullptr)
+{
+    if (index)
     {
-        auto sname = LLVMGetSymbolName(it);
+        //- Newer dylibs shadow older ones (push_front)...
 
-        if (auto sym = unwrap(jit)->lookup(*unwrap(jd), sname))
+        for (auto sname : ol.index_names)
         {
-            auto addr = sym->getValue();
+            auto raw_name = demangle_symbol_name(sname);
+
+            (*index)[v_quark_from_string_n(raw_name.data(), raw_name.size())] = {jd, nullptr};
+        }
+    }
+
+    if (ol.lookup_set.empty())  return;
+
+    auto &es = unwrap(voidc_global_ctx_t::jit)->getExecutionSession();
+
+    //-------------------------------------------------------------
+    auto syms = es.lookup(makeJITDylibSearchOrder(unwrap(jd), JITDylibLookupFlags::MatchAllSymbols),
+                          std::move(ol.lookup_set));
+
+    if (!syms)
+    {
+        printf("\n%s\n", toString(syms.takeError()).c_str());
+
+        return;
+    }
 
-            if (!req) continue;
+    for (auto &it : *syms)
+    {
+        StringRef sname = *it.first;
+
+        auto addr = LLVMOrcJITTargetAddress(uintptr_t(symbol_def_address(it.second)));
 
-            for (int i=0; req[i].prefix; ++i)
+        for (int i=0; req && req[i].prefix; ++i)
+        {
+            if (name_starts_with(sname, StringRef(req[i].prefix, req[i].length)))
             {
-                if (std::strncmp(sname, req[i].prefix, req[i].length) == 0)
-                {
-                    req[i].addr = addr;
-                }
+                req[i].addr = addr;
             }
         }
-
-        LLVMMoveToNextSymbol(it);
     }
 
-    LLVMDisposeSymbolIterator(it);
+//  unwrap(jd)->dump(outs());
+}
 
-    //-------------------------------------------------------------
-    LLVMDisposeBinary(bref);
+//---------------------------------------------------------------------
+static void
+add_object_file_to_jd_with_rt(LLVMMemoryBufferRef membuf,
+                              LLVMOrcJITDylibRef jd,
+                              LLVMOrcResourceTrackerRef rt,
+                              search_request_t *req,
+                              voidc_symbol_index_t *index = nullptr)
+{
+    object_lookup_t ol;
 
-//  unwrap(jd)->dump(outs());
+    if (!add_object_file_to_rt(membuf, rt, req, index != nullptr, ol))  return;
+
+    lookup_object_file_symbols(jd, ol, req, index);         //- Right here, membuf is alive
 }
 
 //---------------------------------------------------------------------
+//- Object groups: partitions of one module refer to each other, so all
+//- of them must be in the dylib before the first lookup (materialization)
+//- of any. Lookups (with init/term functions etc.) are deferred till the
+//- end of the group...
+//- State is per local context (units run there), see object_group_t...
+//---------------------------------------------------------------------
+static voidc_local_ctx_t::object_group_t &
+local_object_group(void)
+{
+    return  static_cast<voidc_local_ctx_t &>(*voidc_global_ctx_t::voidc->local_ctx).object_group;
+}
+
+static voidc_local_ctx_t::object_group_t *
+current_object_group(void)          //- nullptr - not in a group
+{
+    if (!voidc_global_ctx_t::voidc->local_ctx)  return nullptr;
+
+    auto &grp = local_object_group();
+
+    return  (grp.depth > 0 ? &grp : nullptr);
+}
+
+static void
+object_group_begin(void)
+{
+    auto &grp = local_object_group();
+
+    if (grp.depth++ == 0)  grp.jd = nullptr;
+}
+
 static void
-add_object_file_to_jd(LLVMMemoryBufferRef membuf,
-                      LLVMOrcJITDylibRef jd,
-                      search_request_t *req)
+object_group_end(void)
 {
-    add_object_file_to_jd_with_rt(membuf, jd, LLVMOrcJITDylibGetDefaultResourceTracker(jd), req);
+    auto &grp = local_object_group();
+
+    assert(grp.depth > 0);
+
+    if (--grp.depth > 0)  return;
+
+    auto pending = std::move(grp.pending);
+
+    grp.pending.clear();
+
+    grp.jd = nullptr;
+
+    for (auto &finish : pending)  finish();
 }
 
 //---------------------------------------------------------------------
@@ -1669,23 +1951,36 @@ voidc_template_ctx_t<T, TArgs...>::add_object_file_to_jit(LLVMMemoryBufferRef me
 {
 //  assert(voidc_global_ctx_t::target == voidc_global_ctx_t::voidc);    //- Sic !?!
 
-    auto es = LLVMOrcLLJITGetExecutionSession(voidc_global_ctx_t::jit);
-
     auto &vctx = *voidc_global_ctx_t::voidc;
 
-    std::string jd_name("voidc_jd_" + std::to_string(vctx.jd_hash));
+    //- Partitions of a module (one group) share the dylib of the first one...
+
+    auto *grp = current_object_group();
 
-    vctx.jd_hash += 1;
+    bool reuse = (grp  &&  grp->jd);
 
     LLVMOrcJITDylibRef jd = nullptr;
 
-    LLVMOrcExecutionSessionCreateJITDylib(es, &jd, jd_name.c_str());
+    if (reuse)
+    {
+        jd = grp->jd;
+    }
+    else
+    {
+        auto es = LLVMOrcLLJITGetExecutionSession(voidc_global_ctx_t::jit);
 
-    assert(jd);
+        std::string jd_name("voidc_jd_" + std::to_string(vctx.jd_hash));
 
-    setup_link_order(jd);
+        vctx.jd_hash += 1;
 
-    search_request_t req[] =
+        LLVMOrcExecutionSessionCreateJITDylib(es, &jd, jd_name.c_str());
+
+        assert(jd);
+
+        if (grp)  grp->jd = jd;
+    }
+
+    static const search_request_t init_term_req[] =
     {
         { "voidc.init_func.", 16, 0 },
         { "voidc.term_func.", 16, 0 },
@@ -1693,30 +1988,59 @@ voidc_template_ctx_t<T, TArgs...>::add_object_file_to_jit(LLVMMemoryBufferRef me
         { 0, 0, 0 }
     };
 
-    add_object_file_to_jd(membuf, jd, req);
+    object_lookup_t ol;
 
-    if (auto addr = req[0].addr)
+    auto rt = LLVMOrcJITDylibGetDefaultResourceTracker(jd);
+
+    if (!add_object_file_to_rt(membuf, rt, init_term_req, true, ol))  ol = object_lookup_t();
+
+    //-------------------------------------------------------------
+    auto finish = [this, jd, reuse, ol]() mutable
     {
-        void (*init_fun)() = (void (*)())addr;
+        auto &vctx = *voidc_global_ctx_t::voidc;
 
-        init_fun();
-    }
+        setup_link_order(jd);
 
-    unwrap(jd)->setLinkOrder({{unwrap(vctx.base_jd), JITDylibLookupFlags::MatchAllSymbols}});       //- Sic!    WTF?
+        search_request_t req[] =
+        {
+            init_term_req[0],
+            init_term_req[1],
+            init_term_req[2]
+        };
 
-    deque_jd.push_front(jd);
+        lookup_object_file_symbols(jd, ol, req, &symbol_index);
 
-    if (auto addr = req[1].addr)
-    {
-        auto cleaner = [](void *data)
+        if (auto addr = req[0].addr)
         {
-            void (*term_fun)() = (void (*)())data;
+            void (*init_fun)() = (void (*)())addr;
 
-            term_fun();
-        };
+            init_fun();
+        }
 
-        this->add_cleaner(cleaner, (void *)addr);
-    }
+        unwrap(jd)->setLinkOrder({{unwrap(vctx.base_jd), JITDylibLookupFlags::MatchAllSymbols}});       //- Sic!    WTF?
+
+        if (!reuse)
+        {
+            deque_jd.push_front(jd);
+
+            link_order_stamp += 1;
+        }
+
+        if (auto addr = req[1].addr)
+        {
+            auto cleaner = [](void *data)
+            {
+                void (*term_fun)() = (void (*)())data;
+
+                term_fun();
+            };
+
+            this->add_cleaner(cleaner, (void *)addr);
+        }
+    };
+
+    if (grp)  grp->pending.push_back(std::move(finish));     //- membuf must stay alive!
+    else      finish();                                     //- Right here, membuf is alive
 }
 
 
@@ -1730,26 +2054,7 @@ voidc_template_ctx_t<T, TArgs...>::add_module_to_jit(LLVMModuleRef mod)
 //  verify_module(mod);
 
     //-------------------------------------------------------------
-    LLVMMemoryBufferRef mod_buffer = nullptr;
-
-    char *msg = nullptr;
-
-    auto err = LLVMTargetMachineEmitToMemoryBuffer(voidc_global_ctx_t::target_machine,
-                                                   mod,
-                                                   LLVMObjectFile,
-                                                   &msg,
-                                                   &mod_buffer);
-
-    if (err)
-    {
-        printf("\n%s\n", msg);
-
-        LLVMDisposeMessage(msg);
-
-        abort();                //- Sic !!!
-    }
-
-    assert(mod_buffer);
+    auto mod_buffer = voidc_global_ctx_t::emit_object_file(mod, voidc_global_ctx_t::get_opt_level(false));
 
     add_object_file_to_jit(mod_buffer);
 
@@ -1804,10 +2109,24 @@ voidc_global_ctx_t::voidc_global_ctx_t()
     //-------------------------------------------------------------
     auto q = v_quark_from_string;
 
-    initialize_type(q("v_type_t"),   type_type);
-    initialize_type(q("v_type_ptr"), type_ptr_type);
+    initialize_type(v_static_quark_v_type_t,   type_type);
+    initialize_type(v_static_quark_v_type_ptr, type_ptr_type);
 
-    initialize_type(q("v_quark_t"), make_uint_type(32));            //- Sic!
+    auto quark_type = make_uint_type(32);
+
+    initialize_type(v_static_quark_v_quark_t, quark_type);          //- Sic!
+
+    {   auto quark_llvm_type = quark_type->llvm_type();
+
+#define DEF(id, str) \
+        decls.constants_insert({q("v_static_quark_" #id), quark_type}); \
+        constant_values.insert({q("v_static_quark_" #id), \
+            LLVMConstInt(quark_llvm_type, v_static_quark_##id, 0)});
+
+        VOIDC_STATIC_QUARKS(DEF)
+
+#undef DEF
+    }
 
     {   v_type_t *types[] =
         {
@@ -1849,98 +2168,190 @@ voidc_global_ctx_t::voidc_global_ctx_t()
 static char *voidc_triple = nullptr;
 
 static v_quark_t voidc_object_file_load_to_jit_internal_helper_q;
+static v_quark_t voidc_object_file_load_to_jit_record_helper_q;
+static v_quark_t voidc_object_file_load_to_jit_group_helper_q;
 
 //---------------------------------------------------------------------
-void
-voidc_global_ctx_t::static_initialize(void)
+//- GDB JIT interface: RuntimeDyld - event listener, JITLink - debug
+//- object plugin (all objects, not only ones with debug sections).
+//---------------------------------------------------------------------
+static void
+enable_gdb_jit_interface(void)
 {
-    auto q = v_quark_from_string;
+    auto &lljit = *unwrap(voidc_global_ctx_t::jit);
 
-    voidc_typenames_q = q("voidc.typenames_dict");
-
-    obtain_alias_q   = q("voidc.hook_obtain_alias");
-    lookup_alias_q   = q("voidc.hook_lookup_alias");
-    obtain_module_q  = q("voidc.hook_obtain_module");
-    finish_module_q  = q("voidc.hook_finish_module");
-    try_to_adopt_q   = q("voidc.hook_try_to_adopt");
-    try_to_convert_q = q("voidc.hook_try_to_convert");
-    make_temporary_q = q("voidc.hook_make_temporary");
-
-#if LLVM_VERSION_MAJOR < 18
-    llvm_stacksave_q                     = q("llvm.stacksave");
-    llvm_stackrestore_q                  = q("llvm.stackrestore");
-#else
-    llvm_stacksave_q                     = q("llvm.stacksave.p0");
-    llvm_stackrestore_q                  = q("llvm.stackrestore.p0");
-#endif
+    auto &es = lljit.getExecutionSession();
 
-    voidc_internal_function_type_q       = q("voidc.internal_function_type");
-    voidc_internal_return_value_q        = q("voidc.internal_return_value");
-    voidc_internal_branch_target_leave_q = q("voidc.internal_branch_target_leave");
+    auto &layer = lljit.getObjLinkingLayer();
 
-    //-------------------------------------------------------------
-    LLVMInitializeAllTargetInfos();
-    LLVMInitializeAllTargets();
-    LLVMInitializeAllTargetMCs();
-    LLVMInitializeAllAsmParsers();
-    LLVMInitializeAllAsmPrinters();
+    if (auto rtdyld = dyn_cast<RTDyldObjectLinkingLayer>(&layer))
+    {
+        rtdyld->registerJITEventListener(*JITEventListener::createGDBRegistrationListener());
+    }
+    else if (auto jitlink = dyn_cast<ObjectLinkingLayer>(&layer))
+    {
+        auto registrar = createJITLoaderGDBRegistrar(es);
 
-    //-------------------------------------------------------------
-    LLVMOrcCreateLLJIT(&jit, 0);            //- Sic!
+        if (!registrar)
+        {
+            printf("\n%s\n", toString(registrar.takeError()).c_str());
 
-    //-------------------------------------------------------------
-    voidc_types_static_initialize();        //- Sic!
+            return;
+        }
 
-    target = new voidc_global_ctx_t();      //- Sic!
+        jitlink->addPlugin(std::make_unique<DebugObjectManagerPlugin>(es, std::move(*registrar), false, true));
+    }
+}
 
-    voidc_types_make_voidc_constants();     //- Sic!
+//---------------------------------------------------------------------
+//- Perf map/jitdump: every function of every object, when it is loaded
+//- (local ones too - static helpers etc.). RuntimeDyld: address is the
+//- section's load address plus the offset. JITLink: right from the graph.
+//---------------------------------------------------------------------
+class jit_events_listener_t : public JITEventListener
+{
+    void notifyObjectLoaded(ObjectKey, const object::ObjectFile &obj, const RuntimeDyld::LoadedObjectInfo &info) override
+    {
+        for (auto &it : object::computeSymbolSizes(obj))
+        {
+            auto &sym = it.first;
 
-    static_cast<voidc_global_ctx_t *>(target)->initialize();    //- Sic!
+            auto type  = sym.getType();
+            auto flags = sym.getFlags();
+            auto name  = sym.getName();
+            auto value = sym.getValue();
+            auto sec   = sym.getSection();
 
-    //-------------------------------------------------------------
-    {   const char *triple = LLVMOrcLLJITGetTripleString(jit);
+            if (!type || !flags || !name || !value || !sec)
+            {
+                consumeError(type.takeError());
+                consumeError(flags.takeError());
+                consumeError(name.takeError());
+                consumeError(value.takeError());
+                consumeError(sec.takeError());
 
-        LLVMTargetRef tr;
+                continue;
+            }
 
-        char *errmsg = nullptr;
+            if (*type != object::SymbolRef::ST_Function  ||  it.second == 0  ||  name->empty())  continue;
 
-        int err = LLVMGetTargetFromTriple(triple, &tr, &errmsg);
+            if ((*flags & object::SymbolRef::SF_Undefined)  ||  *sec == obj.section_end())  continue;
 
-        if (errmsg)
-        {
-            fprintf(stderr, "LLVMGetTargetFromTriple: %s\n", errmsg);
+            uint64_t load_addr = info.getSectionLoadAddress(**sec);
 
-            LLVMDisposeMessage(errmsg);
+            if (!load_addr)  continue;
 
-            errmsg = nullptr;
+            notify_jit_code_load(*name, load_addr + (*value - (*sec)->getAddress()), it.second);
         }
+    }
+};
+
+class jit_events_plugin_t : public ObjectLinkingLayer::Plugin
+{
+    void modifyPassConfig(MaterializationResponsibility &, jitlink::LinkGraph &, jitlink::PassConfiguration &config) override
+    {
+        config.PostFixupPasses.push_back([](jitlink::LinkGraph &g)
+        {
+            for (auto *sym : g.defined_symbols())
+            {
+                if (!sym->hasName()  ||  !sym->isCallable()  ||  sym->getSize() == 0)  continue;
+
+#if LLVM_VERSION_MAJOR < 20
+                StringRef name = sym->getName();
+#else
+                StringRef name = *sym->getName();
+#endif
+
+                notify_jit_code_load(name, sym->getAddress().getValue(), sym->getSize());
+            }
+
+            return Error::success();
+        });
+    }
 
-        assert(err == 0);
+    Error notifyFailed(MaterializationResponsibility &) override  { return Error::success(); }
 
-        char *cpu_name     = LLVMGetHostCPUName();
-        char *cpu_features = LLVMGetHostCPUFeatures();
+#if LLVM_VERSION_MAJOR < 17
+    Error notifyRemovingResources(ResourceKey) override  { return Error::success(); }
 
-        target_machine =
-            LLVMCreateTargetMachine
-            (
-                tr,
-                triple,
-                cpu_name,
-                cpu_features,
-                LLVMCodeGenLevelDefault,
+    void notifyTransferringResources(ResourceKey, ResourceKey) override  {}
+#else
+    Error notifyRemovingResources(JITDylib &, ResourceKey) override  { return Error::success(); }
+
+    void notifyTransferringResources(JITDylib &, ResourceKey, ResourceKey) override  {}
+#endif
+};
 
-#ifdef _WIN32                                       //- WTF !?!
-                LLVMRelocDefault,                   //- WTF !?!
-#else                                               //- WTF !?!
-                LLVMRelocPIC,                       //- WTF !?!
-#endif                                              //- WTF !?!
+static void
+enable_jit_code_events(void)
+{
+    auto &layer = unwrap(voidc_global_ctx_t::jit)->getObjLinkingLayer();
 
-                LLVMCodeModelJITDefault
-            );
+    if (auto rtdyld = dyn_cast<RTDyldObjectLinkingLayer>(&layer))
+    {
+        static jit_events_listener_t listener;
 
-        LLVMDisposeMessage(cpu_features);
-        LLVMDisposeMessage(cpu_name);
+        rtdyld->registerJITEventListener(listener);
+    }
+    else if (auto jitlink = dyn_cast<ObjectLinkingLayer>(&layer))
+    {
+        jitlink->addPlugin(std::make_unique<jit_events_plugin_t>());
     }
+}
+
+//---------------------------------------------------------------------
+void
+voidc_global_ctx_t::static_initialize(void)
+{
+    auto q = v_quark_from_string;
+
+    voidc_typenames_q = v_static_quark_voidc_typenames_dict;
+
+    obtain_alias_q   = v_static_quark_voidc_hook_obtain_alias;
+    lookup_alias_q   = v_static_quark_voidc_hook_lookup_alias;
+    obtain_module_q  = v_static_quark_voidc_hook_obtain_module;
+    finish_module_q  = v_static_quark_voidc_hook_finish_module;
+    try_to_adopt_q   = v_static_quark_voidc_hook_try_to_adopt;
+    try_to_convert_q = v_static_quark_voidc_hook_try_to_convert;
+    make_temporary_q = v_static_quark_voidc_hook_make_temporary;
+
+#if LLVM_VERSION_MAJOR < 18
+    llvm_stacksave_q                     = q("llvm.stacksave");
+    llvm_stackrestore_q                  = q("llvm.stackrestore");
+#else
+    llvm_stacksave_q                     = q("llvm.stacksave.p0");
+    llvm_stackrestore_q                  = q("llvm.stackrestore.p0");
+#endif
+
+    voidc_internal_function_type_q       = v_static_quark_voidc_internal_function_type;
+    voidc_internal_return_value_q        = v_static_quark_voidc_internal_return_value;
+    voidc_internal_branch_target_leave_q = v_static_quark_voidc_internal_branch_target_leave;
+
+    //-------------------------------------------------------------
+    LLVMInitializeAllTargetInfos();
+    LLVMInitializeAllTargets();
+    LLVMInitializeAllTargetMCs();
+    LLVMInitializeAllAsmParsers();
+    LLVMInitializeAllAsmPrinters();
+
+    //-------------------------------------------------------------
+    LLVMOrcCreateLLJIT(&jit, 0);            //- Sic!
+
+    if (voidc_jit_events_flags() & voidc_jit_events_gdb)  enable_gdb_jit_interface();
+
+    if (voidc_jit_events_code_enabled())  enable_jit_code_events();
+
+    //-------------------------------------------------------------
+    voidc_types_static_initialize();        //- Sic!
+
+    target = new voidc_global_ctx_t();      //- Sic!
+
+    voidc_types_make_voidc_constants();     //- Sic!
+
+    static_cast<voidc_global_ctx_t *>(target)->initialize();    //- Sic!
+
+    //-------------------------------------------------------------
+    target_machine = get_target_machine(2);
 
     voidc->data_layout = LLVMCreateTargetDataLayout(target_machine);
     voidc_triple       = LLVMGetTargetMachineTriple(target_machine);
@@ -1954,7 +2365,7 @@ voidc_global_ctx_t::static_initialize(void)
 #undef DEF
 
     //-------------------------------------------------------------
-    voidc_object_file_load_to_jit_internal_helper_q = q("voidc_object_file_load_to_jit_internal_helper");
+    voidc_object_file_load_to_jit_internal_helper_q = v_static_quark_voidc_object_file_load_to_jit_internal_helper;
 
     {   v_type_t *typ[3];
 
@@ -1967,9 +2378,36 @@ voidc_global_ctx_t::static_initialize(void)
         voidc->decls.symbols_insert({voidc_object_file_load_to_jit_internal_helper_q, ft});
     }
 
+    voidc_object_file_load_to_jit_record_helper_q = v_static_quark_voidc_object_file_load_to_jit_record_helper;
+
+    {   v_type_t *typ[2];
+
+        typ[0] = voidc->size_t_type;
+        typ[1] = voidc->bool_type;
+
+        auto ft = voidc->make_function_type(voidc->void_type, typ, 2, false);
+
+        voidc->decls.symbols_insert({voidc_object_file_load_to_jit_record_helper_q, ft});
+    }
+
+    voidc_object_file_load_to_jit_group_helper_q = v_static_quark_voidc_object_file_load_to_jit_group_helper;
+
+    {   v_type_t *typ[2];
+
+        typ[0] = voidc->bool_type;
+        typ[1] = voidc->bool_type;
+
+        auto ft = voidc->make_function_type(voidc->void_type, typ, 2, false);
+
+        voidc->decls.symbols_insert({voidc_object_file_load_to_jit_group_helper_q, ft});
+    }
+
     //-------------------------------------------------------------
     voidc->flush_unit_symbols();
 
+    //-------------------------------------------------------------
+    compile_pipeline = new compile_pipeline_t;
+
     //-------------------------------------------------------------
 #ifndef NDEBUG
 
@@ -1979,6 +2417,8 @@ voidc_global_ctx_t::static_initialize(void)
 }
 
 //---------------------------------------------------------------------
+static void compile_pool_terminate(void);       //- See below...
+
 void
 voidc_global_ctx_t::static_terminate(void)
 {
@@ -1991,17 +2431,104 @@ voidc_global_ctx_t::static_terminate(void)
 
     delete voidc;
 
+    unit_jd_pool.clear();
+
+    delete lazy_layer;          //- After dylibs, before LLJIT
+
+    lazy_layer = nullptr;
+
+    compile_pool_terminate();   //- Before the pipeline (used by run)
+
+    delete compile_pipeline;
+
+    compile_pipeline = nullptr;
+
     LLVMOrcDisposeLLJIT(jit);
 
     LLVMShutdown();
 }
 
 
+//---------------------------------------------------------------------
+//- Optimization policy
+//---------------------------------------------------------------------
+//- Unit actions usually run just once: O0 (i.e. FastISel) by default.
+//- Modules: O3. Overrides - voidc constants "voidc.opt_level_unit_action"
+//- and "voidc.opt_level_module" (raw "0".."3" strings, like the
+//- "voidc.import_bin_filename_*" ones), command line wins over them...
+//---------------------------------------------------------------------
+static int forced_opt_level[2] = {-1, -1};      //- [module, unit_action]
+
+static LLVMTargetMachineRef target_machines[3];   //- None, Less, Default
+
+extern "C"
+LLVMValueRef v_target_global_ctx_get_constant_value(base_global_ctx_t *, v_quark_t);
+
+int
+voidc_global_ctx_t::get_opt_level(bool unit_action)
+{
+    if (int level = forced_opt_level[unit_action];  level >= 0)  return level;
+
+    v_quark_t q = (unit_action ? v_static_quark_voidc_opt_level_unit_action
+                               : v_static_quark_voidc_opt_level_module);
+
+    if (auto v = v_target_global_ctx_get_constant_value(voidc, q))
+    {
+        auto *str = (const char *)v;
+
+        if (str[0] >= '0'  &&  str[0] <= '3'  &&  str[1] == 0)  return  str[0] - '0';
+    }
+
+    return  (unit_action ? 0 : 3);
+}
+
+LLVMTargetMachineRef
+voidc_global_ctx_t::get_target_machine(int opt_level)
+{
+    int idx = std::min(opt_level, 2);           //- O3 -> LLVMCodeGenLevelDefault (as before)
+
+    if (auto tm = target_machines[idx])  return tm;
+
+    auto tm = create_target_machine(opt_level);
+
+    target_machines[idx] = tm;
+
+    return tm;
+}
+
+
+//---------------------------------------------------------------------
+compile_pipeline_t *voidc_global_ctx_t::compile_pipeline = nullptr;
+
+LLVMMemoryBufferRef
+voidc_global_ctx_t::emit_object_file(LLVMModuleRef module, int opt_level)
+{
+    assert(compile_pipeline);
+
+    auto membuf = compile_pipeline->emit(*unwrap(module), opt_level);
+
+    if (!membuf)
+    {
+        printf("\n%s\n", toString(membuf.takeError()).c_str());
+
+        abort();                //- Sic !!!
+    }
+
+    return  wrap(membuf->release());
+}
+
+
 //---------------------------------------------------------------------
 static bool verify_jit_module_optimized = false;
 
 void
 voidc_global_ctx_t::prepare_module_for_jit(LLVMModuleRef module)
+{
+    prepare_module_for_jit(module, get_opt_level(false));
+}
+
+void
+voidc_global_ctx_t::prepare_module_for_jit(LLVMModuleRef module, int opt_level)
 {
     assert(target == voidc);    //- Sic!
 
@@ -2012,272 +2539,924 @@ voidc_global_ctx_t::prepare_module_for_jit(LLVMModuleRef module)
     LLVMSetTarget(module, voidc_triple);
 
     //-------------------------------------------------------------
-    auto opts = LLVMCreatePassBuilderOptions();
-
-    auto err = LLVMRunPasses(module, "default<O3>", target_machine, opts);
-
-    if (err)
+    if (auto err = compile_pipeline->optimize(*unwrap(module), opt_level))
     {
-        auto msg = LLVMGetErrorMessage(err);
-
-        printf("LLVMRunPasses: %s\n", msg);
-
-        LLVMDisposeErrorMessage(msg);
+        printf("LLVMRunPasses: %s\n", toString(std::move(err)).c_str());
     }
 
-    LLVMDisposePassBuilderOptions(opts);
-
     //-------------------------------------------------------------
     if (verify_jit_module_optimized)  verify_module(module);
 }
 
 
 //---------------------------------------------------------------------
-//- Voidc Local Context
+//- Partitioned compilation
 //---------------------------------------------------------------------
-static bool voidc_try_to_adopt_default(void *, v_type_t *type, LLVMValueRef value);
+//- Big modules are split by functions (local symbols stay together with
+//- their users), each partition goes to its own LLVMContext (through
+//- bitcode) and is optimized and emitted on a worker thread. Objects of
+//- one module are loaded as a group: they share a JITDylib and are looked
+//- up only after all of them are added (see object_group_begin/end).
+//- Opt-in (voidc -j): partitions are not inlined into each other...
+//---------------------------------------------------------------------
+static int compile_threads = 1;                 //- 1 - no partitioning, 0 - hardware concurrency
 
-voidc_local_ctx_t::voidc_local_ctx_t(voidc_global_ctx_t &global)
-  : voidc_template_ctx_t(global)
+static unsigned
+compile_threads_count(void)
 {
-    compiler = make_level_0_voidc_compiler();
+    unsigned threads = compile_threads;
 
-    set_try_to_adopt_hook(voidc_try_to_adopt_default, this);
+    if (threads == 0)  threads = std::thread::hardware_concurrency();
 
-    auto es = LLVMOrcLLJITGetExecutionSession(voidc_global_ctx_t::jit);
+    return threads;
+}
 
-    std::string jd_name("voidc_jd_" + std::to_string(global.jd_hash));
+static const size_t partition_min_functions = 16;
 
-    global.jd_hash += 1;
+static unsigned
+module_partitions_count(Module &module)
+{
+    unsigned threads = compile_threads_count();
 
-    LLVMOrcExecutionSessionCreateJITDylib(es, &base_jd, jd_name.c_str());
+    if (threads < 2)  return 1;
 
-    assert(base_jd);
+    size_t functions = 0;
 
-    setup_link_order(base_jd);
+    for (auto &f : module)  if (!f.isDeclaration())  ++functions;
 
-    deque_jd.push_front(base_jd);
+    if (functions < 2*partition_min_functions)  return 1;
+
+    for (auto &gv : module.globals())
+    {
+        if (gv.hasAppendingLinkage())  return 1;        //- llvm.global_ctors etc. - as a whole
+    }
+
+    return  unsigned(std::min<size_t>(threads, functions / partition_min_functions));
 }
 
-//---------------------------------------------------------------------
-voidc_local_ctx_t::~voidc_local_ctx_t()
+static bool
+module_has_definitions(Module &module)
 {
-    run_cleaners();
+    for (auto &gv : module.global_values())
+    {
+        if (!gv.isDeclaration())  return true;
+    }
+
+    return false;
 }
 
 
 //---------------------------------------------------------------------
-void
-voidc_local_ctx_t::export_type(v_quark_t type_name, v_type_t *type)
-{
-    base_local_ctx_t::export_type(type_name, type);
+static compile_pool_t *compile_pool = nullptr;        //- Created on demand, see voidc_compile_pipeline.h
 
-    auto raw_name = lookup_alias(type_name);
+static void
+compile_pool_terminate(void)
+{
+    delete compile_pool;
 
-    export_overload(voidc_typenames_q, type, raw_name);          //- Sic!
+    compile_pool = nullptr;
 }
 
+
 //---------------------------------------------------------------------
-void
-voidc_local_ctx_t::add_type(v_quark_t type_name, v_type_t *type)
+std::vector<LLVMMemoryBufferRef>
+voidc_global_ctx_t::compile_module_for_jit(LLVMModuleRef module)
 {
-    base_local_ctx_t::add_type(type_name, type);
+    int opt_level = get_opt_level(false);
 
-    auto raw_name = lookup_alias(type_name);
+    auto &mod = *unwrap(module);
 
-    add_overload(voidc_typenames_q, type, raw_name);            //- Sic!
-}
+    unsigned n = module_partitions_count(mod);
 
+    if (n < 2)
+    {
+        prepare_module_for_jit(module, opt_level);
 
-//---------------------------------------------------------------------
-void *
-voidc_local_ctx_t::find_symbol_value(v_quark_t raw_name_q)
-{
-    auto raw_name = v_quark_to_string(raw_name_q);
+        return { emit_object_file(module, opt_level) };
+    }
 
-    auto &vctx = *voidc_global_ctx_t::voidc;
+    //-------------------------------------------------------------
+    assert(target == voidc);    //- Sic!
+
+    verify_module(module);
+
+    LLVMSetModuleDataLayout(module, voidc->data_layout);
+    LLVMSetTarget(module, voidc_triple);
+
+    //-------------------------------------------------------------
+    std::vector<SmallString<0>> parts;
+
+    SplitModule(mod, n, [&parts](std::unique_ptr<Module> part)
+    {
+        if (!module_has_definitions(*part))  return;
+
+        raw_svector_ostream os(parts.emplace_back());
+
+        WriteBitcodeToFile(*part, os);
+
+    }, true);       //- PreserveLocals
 
-    std::deque<LLVMOrcJITDylibRef> main_dq = {vctx.base_jd};
+    //-------------------------------------------------------------
+    const std::string name = mod.getModuleIdentifier();
+
+    std::vector<std::unique_ptr<MemoryBuffer>> objects(parts.size());
 
-    for (auto dq : {deque_jd, vctx.deque_jd, main_dq})
+    compile_pool_t::job_t job = [&](compile_pipeline_t &pipeline, size_t i)
     {
-        for (auto jd : dq)
+        LLVMContext ctx;
+
+        auto part = parseBitcodeFile(MemoryBufferRef(parts[i].str(), name), ctx);
+
+        if (!part)
         {
-            auto sym = unwrap(voidc_global_ctx_t::jit)->lookup(*unwrap(jd), raw_name);
+            fprintf(stderr, "parseBitcodeFile: %s\n", toString(part.takeError()).c_str());
 
-            if (sym)  return (void *)sym->getValue();
+            return;
         }
+
+        if (auto err = pipeline.optimize(**part, opt_level))
+        {
+            fprintf(stderr, "LLVMRunPasses: %s\n", toString(std::move(err)).c_str());
+        }
+
+        if (verify_jit_module_optimized  &&  verifyModule(**part, &errs()))  return;
+
+        if (auto obj = pipeline.emit(**part, opt_level))  objects[i] = std::move(*obj);
+        else  fprintf(stderr, "\n%s\n", toString(obj.takeError()).c_str());
+    };
+
+    if (!compile_pool)  compile_pool = new compile_pool_t(compile_threads_count() - 1);
+
+    compile_pool->run(parts.size(), job, *compile_pipeline);
+
+    //-------------------------------------------------------------
+    std::vector<LLVMMemoryBufferRef> ret;
+
+    for (auto &obj : objects)
+    {
+        if (!obj)  abort();     //- Sic !!!
+
+        ret.push_back(wrap(obj.release()));
     }
 
-    return nullptr;
+    return ret;
 }
 
 
 //---------------------------------------------------------------------
-extern "C"
+//- Lazy modules
+//---------------------------------------------------------------------
+//- Opt-in: global modules are embedded into unit actions as bitcode,
+//- which is loaded through the lazy layer. Each such module gets its
+//- own dylib: COD layer keeps per-dylib stubs, so dylibs are never
+//- shared with objects. Import binaries keep whatever the writer had:
+//- bitcode records (tagged, see voidc_import_binary.h) are loaded lazily with
+//- -L and compiled right away without it, see add_bitcode_module_to_jit.
+//- Local modules (their dylibs are removed with the context) and
+//- modules with appending globals (llvm.global_ctors etc.) stay eager.
+//---------------------------------------------------------------------
+static bool lazy_modules = false;
+
+lazy_layer_t *voidc_global_ctx_t::lazy_layer = nullptr;
+
+static bool
+module_can_be_lazy(Module &module)
 {
+    for (auto &gv : module.globals())
+    {
+        if (gv.hasAppendingLinkage())  return false;
+    }
+
+    return true;
+}
 
 static bool
-voidc_try_to_adopt_default(void *void_ctx, v_type_t *type, LLVMValueRef value)
+is_bitcode_buffer(LLVMMemoryBufferRef membuf)
 {
-    auto &vctx = *voidc_global_ctx_t::voidc;
-    auto &lctx = *(reinterpret_cast<voidc_local_ctx_t *>(void_ctx));
+    auto *p = (const unsigned char *)LLVMGetBufferStart(membuf);
 
-    if (lctx.result_type == UNREFERENCE_TAG  &&  type == vctx.static_type_type)
+    return  (LLVMGetBufferSize(membuf) >= 4  &&
+             p[0] == 'B'  &&  p[1] == 'C'  &&  p[2] == 0xC0  &&  p[3] == 0xDE);
+}
+
+//---------------------------------------------------------------------
+static void
+add_bitcode_module_to_jit(LLVMMemoryBufferRef bitcode)
+{
+    auto &gctx = *voidc_global_ctx_t::voidc;
+
+    if (lazy_modules)
     {
-        const v_quark_t *pq = nullptr;
+        gctx.add_lazy_module_to_jit(bitcode);
 
-        if (auto *i = lctx.decls.overloads.find(voidc_typenames_q))         //- WTF ?!?!?!?!?!?!?
-        {
-            pq = i->find(reinterpret_cast<v_type_t *>(value));
-        }
+        return;
+    }
+
+    //- Lazy-ready module, but no -L: compile it right now...
+
+    LLVMModuleRef mod = nullptr;
+
+    if (LLVMParseBitcodeInContext2(gctx.llvm_ctx, bitcode, &mod))
+    {
+        printf("\nBroken module bitcode\n");
+
+        abort();            //- Sic !!!
+    }
+
+    auto saved_target = voidc_global_ctx_t::target;
+
+    voidc_global_ctx_t::target = &gctx;         //- Sic!
+
+    auto membufs = voidc_global_ctx_t::compile_module_for_jit(mod);
+
+    voidc_global_ctx_t::target = saved_target;
+
+    LLVMDisposeModule(mod);
+
+    bool group = (membufs.size() > 1);      //- Partitions
+
+    if (group)  object_group_begin();
+
+    for (auto membuf : membufs)  gctx.add_object_file_to_jit(membuf);
+
+    if (group)  object_group_end();
+
+    for (auto membuf : membufs)  LLVMDisposeMemoryBuffer(membuf);      //- After the group's lookups
+}
+
+//---------------------------------------------------------------------
+void
+voidc_global_ctx_t::add_lazy_module_to_jit(LLVMMemoryBufferRef bitcode)
+{
+    auto &lljit = *unwrap(jit);
+
+    auto &es = lljit.getExecutionSession();
+
+    if (!lazy_layer)  lazy_layer = lazy_layer_t::create(lljit);
+
+    if (!lazy_layer)  abort();      //- Sic !!!
+
+    //-------------------------------------------------------------
+    auto tsctx = std::make_unique<LLVMContext>();
+
+    auto mod = parseBitcodeFile(unwrap(bitcode)->getMemBufferRef(), *tsctx);
+
+    if (!mod)
+    {
+        printf("\n%s\n", toString(mod.takeError()).c_str());
+
+        return;
+    }
+
+    std::vector<std::string> names;         //- Raw ones
+
+    for (auto &gv : (*mod)->global_values())
+    {
+        if (!gv.isDeclaration()  &&  !gv.hasLocalLinkage())  names.push_back(gv.getName().str());
+    }
+
+    //-------------------------------------------------------------
+    LLVMOrcJITDylibRef jd = nullptr;
+
+    std::string jd_name("voidc_jd_" + std::to_string(jd_hash));
+
+    jd_hash += 1;
+
+    LLVMOrcExecutionSessionCreateJITDylib(LLVMOrcLLJITGetExecutionSession(jit), &jd, jd_name.c_str());
+
+    assert(jd);
+
+    //- Functions are compiled later: link order must not refer to
+    //- the local context (see setup_link_order)...
+
+#ifdef _WIN32
+    const auto flags = JITDylibLookupFlags::MatchAllSymbols;
+#else
+    const auto flags = JITDylibLookupFlags::MatchExportedSymbolsOnly;
+#endif
+
+    JITDylibSearchOrder so;
+
+    so.push_back({unwrap(jd), flags});
+
+    for (auto _jd : deque_jd)  so.push_back({unwrap(_jd), flags});
+
+    so.push_back({unwrap(base_jd), JITDylibLookupFlags::MatchAllSymbols});
+
+    unwrap(jd)->setLinkOrder(so, false);        //- Set "as is"
+
+    if (auto err = lazy_layer->add(*unwrap(jd), ThreadSafeModule(std::move(*mod), std::move(tsctx))))
+    {
+        printf("\n%s\n", toString(std::move(err)).c_str());
+
+        return;
+    }
+
+    //-------------------------------------------------------------
+    SymbolLookupSet lookup_set;
+
+    for (auto &name : names)
+    {
+        lookup_set.add(lljit.mangleAndIntern(name), SymbolLookupFlags::WeaklyReferencedSymbol);
+    }
+
+    auto syms = es.lookup(makeJITDylibSearchOrder(unwrap(jd), JITDylibLookupFlags::MatchAllSymbols),
+                          std::move(lookup_set));           //- Stubs - no compilation yet
+
+    if (!syms)
+    {
+        printf("\n%s\n", toString(syms.takeError()).c_str());
+
+        return;
+    }
+
+    void *init_fun = nullptr;
+
+    for (auto &it : *syms)
+    {
+        auto raw_name = demangle_symbol_name(*it.first);
+
+        auto addr = symbol_def_address(it.second);
+
+        symbol_index[v_quark_from_string_n(raw_name.data(), raw_name.size())] = {jd, addr};
+
+        if (name_starts_with(raw_name, "voidc.init_func."))  init_fun = addr;
+
+        if (name_starts_with(raw_name, "voidc.term_func."))
+        {
+            auto cleaner = [](void *data)
+            {
+                void (*term_fun)() = (void (*)())data;
+
+                term_fun();
+            };
+
+            add_cleaner(cleaner, addr);
+        }
+    }
+
+    //-------------------------------------------------------------
+    deque_jd.push_front(jd);
+
+    link_order_stamp += 1;
+
+    if (init_fun)  ((void (*)())init_fun)();
+}
+
+
+//---------------------------------------------------------------------
+//- Voidc Local Context
+//---------------------------------------------------------------------
+static bool voidc_try_to_adopt_default(void *, v_type_t *type, LLVMValueRef value);
+
+voidc_local_ctx_t::voidc_local_ctx_t(voidc_global_ctx_t &global)
+  : voidc_template_ctx_t(global)
+{
+    compiler = make_level_0_voidc_compiler();
+
+    set_try_to_adopt_hook(voidc_try_to_adopt_default, this);
+
+    auto es = LLVMOrcLLJITGetExecutionSession(voidc_global_ctx_t::jit);
+
+    std::string jd_name("voidc_jd_" + std::to_string(global.jd_hash));
+
+    global.jd_hash += 1;
+
+    LLVMOrcExecutionSessionCreateJITDylib(es, &base_jd, jd_name.c_str());
+
+    assert(base_jd);
+
+    setup_link_order(base_jd);
+
+    deque_jd.push_front(base_jd);
+
+    link_order_stamp += 1;
+}
+
+//---------------------------------------------------------------------
+voidc_local_ctx_t::~voidc_local_ctx_t()
+{
+    run_cleaners();
+}
+
+
+//---------------------------------------------------------------------
+void
+voidc_local_ctx_t::export_type(v_quark_t type_name, v_type_t *type)
+{
+    base_local_ctx_t::export_type(type_name, type);
+
+    auto raw_name = lookup_alias(type_name);
+
+    export_overload(voidc_typenames_q, type, raw_name);          //- Sic!
+}
+
+//---------------------------------------------------------------------
+void
+voidc_local_ctx_t::add_type(v_quark_t type_name, v_type_t *type)
+{
+    base_local_ctx_t::add_type(type_name, type);
+
+    auto raw_name = lookup_alias(type_name);
+
+    add_overload(voidc_typenames_q, type, raw_name);            //- Sic!
+}
+
+
+//---------------------------------------------------------------------
+//- Process symbols (found via base_jd's generator) are cached apart:
+//- a later definition (in symbol_index) must shadow them...
+//---------------------------------------------------------------------
+static std::unordered_map<v_quark_t, void *> process_symbol_cache;
+
+void *
+voidc_local_ctx_t::find_symbol_value(v_quark_t raw_name_q)
+{
+    auto &vctx = *voidc_global_ctx_t::voidc;
+
+    //- Same order as the dylibs search: local, global, base_jd...
+
+    auto raw_name = v_quark_to_string(raw_name_q);
+
+    for (auto *index : {&symbol_index, &vctx.symbol_index})
+    {
+        auto it = index->find(raw_name_q);
+
+        if (it == index->end())  continue;
+
+        auto &e = it->second;
+
+        if (!e.value)           //- Just the dylib yet: look it up (once)
+        {
+            auto sym = unwrap(voidc_global_ctx_t::jit)->lookup(*unwrap(e.jd), raw_name);
+
+            if (!sym)
+            {
+                consumeError(sym.takeError());
+
+                return nullptr;
+            }
+
+            e.value = (void *)sym->getValue();
+        }
+
+        return e.value;
+    }
+
+    //- Not indexed: process symbols (via generator)
+
+    if (auto it = process_symbol_cache.find(raw_name_q);  it != process_symbol_cache.end())  return it->second;
+
+    auto sym = unwrap(voidc_global_ctx_t::jit)->lookup(*unwrap(vctx.base_jd), raw_name);
+
+    if (!sym)
+    {
+        consumeError(sym.takeError());
+
+        return nullptr;
+    }
+
+    auto value = (void *)sym->getValue();
+
+    process_symbol_cache[raw_name_q] = value;
+
+    return value;
+}
+
+
+//---------------------------------------------------------------------
+extern "C"
+{
+
+static bool
+voidc_try_to_adopt_default(void *void_ctx, v_type_t *type, LLVMValueRef value)
+{
+    auto &vctx = *voidc_global_ctx_t::voidc;
+    auto &lctx = *(reinterpret_cast<voidc_local_ctx_t *>(void_ctx));
+
+    if (lctx.result_type == UNREFERENCE_TAG  &&  type == vctx.static_type_type)
+    {
+        const v_quark_t *pq = nullptr;
+
+        if (auto *i = lctx.decls.overloads.find(voidc_typenames_q))         //- WTF ?!?!?!?!?!?!?
+        {
+            pq = i->find(reinterpret_cast<v_type_t *>(value));
+        }
 
         if (pq)
         {
             auto q = *pq;
 
-            auto t = lctx.get_symbol_type(q);
+            auto t = lctx.get_symbol_type(q);
+
+            assert(t == vctx.type_type);
+
+            auto cname = v_quark_to_string(q);
+
+            auto v = LLVMGetNamedGlobal(lctx.module, cname);
+
+            if (!v) v = LLVMAddGlobal(lctx.module, t->llvm_type(), cname);
+
+            lctx.result_type  = vctx.type_ptr_type;
+            lctx.result_value = v;
+
+            return true;
+        }
+    }
+
+    return base_try_to_adopt_default(void_ctx, type, value);            //- Sic!
+}
+
+}
+
+//---------------------------------------------------------------------
+//- Unit actions: interpreter or native code
+//---------------------------------------------------------------------
+//- "Simple" unit actions (see voidc_interp.h) are kept as bitcode and
+//- interpreted, the rest are compiled as before. Both kinds of buffers
+//- go to the import cache "as is"...
+//---------------------------------------------------------------------
+static bool unit_interp_enabled = true;
+
+enum
+{
+    unit_action_count_interpreted,      //- Run
+    unit_action_count_native,           //- Run
+
+    unit_action_count_loop,             //- Compiled, fallback reasons...
+    unit_action_count_unsupported,
+    unit_action_count_disabled,
+
+    unit_action_count_count
+};
+
+static size_t unit_action_counts[unit_action_count_count];
+
+static LLVMValueRef
+find_unit_action(LLVMModuleRef module)
+{
+    for (auto f = LLVMGetFirstFunction(module); f; f = LLVMGetNextFunction(f))
+    {
+        size_t len;
+
+        auto name = LLVMGetValueName2(f, &len);
+
+        if (!LLVMIsDeclaration(f)  &&  std::strncmp(name, "voidc.unit_action_", 18) == 0)  return f;
+    }
+
+    return nullptr;
+}
+
+//---------------------------------------------------------------------
+void
+voidc_local_ctx_t::prepare_unit_action(int line, int column)
+{
+    assert(voidc_global_ctx_t::target == voidc_global_ctx_t::voidc);    //- Sic!
+
+    std::string tail = std::to_string(line) + "_" + std::to_string(column);
+
+    std::string mod_name = "voidc.unit_module_" + tail;
+    std::string fun_name = "voidc.unit_action_" + tail;
+
+    module = LLVMModuleCreateWithNameInContext(mod_name.c_str(), global_ctx.llvm_ctx);
+
+    LLVMSetSourceFileName(module, filename.c_str(), filename.size());
+
+    prepare_function(fun_name.c_str(), global_ctx.make_function_type(global_ctx.void_type, nullptr, 0, false));
+}
+
+//---------------------------------------------------------------------
+void
+voidc_local_ctx_t::finish_unit_action(void)
+{
+    assert(voidc_global_ctx_t::target == voidc_global_ctx_t::voidc);    //- Sic!
+
+    finish_function();
+
+    finish_module(module);
+
+    //-------------------------------------------------------------
+    int fallback = unit_action_count_disabled;
+
+    if (unit_interp_enabled)
+    {
+        switch(voidc_interp_check_module(module, find_unit_action(module)))
+        {
+        case voidc_interp_ok:           fallback = -1;                              break;
+        case voidc_interp_loop:         fallback = unit_action_count_loop;          break;
+        case voidc_interp_unsupported:  fallback = unit_action_count_unsupported;   break;
+        }
+    }
+
+    if (fallback < 0)
+    {
+        //- Bitcode instead of object file - see run_unit_action()
+
+        voidc_global_ctx_t::verify_module(module);
+
+        LLVMSetModuleDataLayout(module, voidc_global_ctx_t::voidc->data_layout);
+        LLVMSetTarget(module, voidc_triple);
+
+        unit_buffer = LLVMWriteBitcodeToMemoryBuffer(module);
+    }
+    else
+    {
+        int opt_level = voidc_global_ctx_t::get_opt_level(true);
+
+        voidc_global_ctx_t::prepare_module_for_jit(module, opt_level);
+
+        unit_buffer = voidc_global_ctx_t::emit_object_file(module, opt_level);
+
+        unit_action_counts[fallback] += 1;
+    }
+
+    assert(unit_buffer);
+
+    //-------------------------------------------------------------
+    LLVMDisposeModule(module);
+
+    vars = variables_t();       //- ?
+}
+
+//---------------------------------------------------------------------
+static unit_jd_t
+unit_jd_acquire(voidc_global_ctx_t &gctx)
+{
+    unit_jd_t ujd = {nullptr, nullptr, 0};
+
+    if (unit_jd_pool.empty())
+    {
+        auto es = LLVMOrcLLJITGetExecutionSession(voidc_global_ctx_t::jit);
+
+        std::string jd_name("voidc_unit_jd_" + std::to_string(gctx.jd_hash));
+
+        gctx.jd_hash += 1;
+
+        LLVMOrcExecutionSessionCreateJITDylib(es, &ujd.jd, jd_name.c_str());
+
+        assert(ujd.jd);
+    }
+    else
+    {
+        ujd = unit_jd_pool.back();
+
+        unit_jd_pool.pop_back();
+    }
+
+    return ujd;
+}
+
+static void
+call_unit_action(const search_request_t *req)          //- init, term, action
+{
+    if (auto addr = req[0].addr)
+    {
+        void (*init_fun)() = (void (*)())addr;
+
+        init_fun();
+    }
+
+    void (*unit_action)() = (void (*)())req[2].addr;
+
+    unit_action();
+
+    if (auto addr = req[1].addr)
+    {
+        void (*term_fun)() = (void (*)())addr;
+
+        term_fun();
+    }
+}
+
+//---------------------------------------------------------------------
+void
+voidc_local_ctx_t::run_unit_action(void)
+{
+    if (!unit_buffer) return;
+
+    auto &gctx = *voidc_global_ctx_t::voidc;
+
+    if (is_bitcode_buffer(unit_buffer))
+    {
+        unit_action_counts[unit_action_count_interpreted] += 1;
+
+        LLVMModuleRef mod = nullptr;
+
+        if (LLVMParseBitcodeInContext2(gctx.llvm_ctx, unit_buffer, &mod))
+        {
+            printf("\nBroken unit action bitcode\n");
+
+            abort();            //- Sic !!!
+        }
+
+        auto resolve = [](void *aux, const char *name)
+        {
+            auto &lctx = *reinterpret_cast<voidc_local_ctx_t *>(aux);
+
+            return  lctx.find_symbol_value(v_quark_from_string(name));
+        };
+
+        voidc_interp_run_function(mod, find_unit_action(mod), gctx.data_layout, resolve, this);
+
+        LLVMDisposeModule(mod);
+
+        flush_unit_symbols();
+
+        fflush(stdout);     //- WTF?
+        fflush(stderr);     //- WTF?
+
+        return;
+    }
+
+    unit_action_counts[unit_action_count_native] += 1;
+
+    auto ujd = unit_jd_acquire(gctx);
+
+    if (ujd.ctx != this  ||  ujd.stamp != link_order_stamp)
+    {
+        setup_link_order(ujd.jd);
+
+        ujd.ctx   = this;
+        ujd.stamp = link_order_stamp;
+    }
+
+    auto jd = ujd.jd;
 
-            assert(t == vctx.type_type);
+    auto rt = LLVMOrcJITDylibCreateResourceTracker(jd);
 
-            auto cname = v_quark_to_string(q);
+    search_request_t req[] =
+    {
+        { "voidc.init_func.", 16, 0 },
+        { "voidc.term_func.", 16, 0 },
 
-            auto v = LLVMGetNamedGlobal(lctx.module, cname);
+        { "voidc.unit_action_", 18, 0 },
 
-            if (!v) v = LLVMAddGlobal(lctx.module, t->llvm_type(), cname);
+        { 0, 0, 0 }
+    };
 
-            lctx.result_type  = vctx.type_ptr_type;
-            lctx.result_value = v;
+    add_object_file_to_jd_with_rt(unit_buffer, jd, rt, req);
 
-            return true;
-        }
-    }
+    call_unit_action(req);
 
-    return base_try_to_adopt_default(void_ctx, type, value);            //- Sic!
-}
+    flush_unit_symbols();
+
+    LLVMOrcResourceTrackerRemove(rt);
+    LLVMOrcReleaseResourceTracker(rt);      //- ?
+
+    unit_jd_pool.push_back(ujd);
 
+    fflush(stdout);     //- WTF?
+    fflush(stderr);     //- WTF?
 }
 
+//---------------------------------------------------------------------
+//- Replay of cached units: native objects of consecutive units go to
+//- one dylib under one resource tracker, all at once. Still, each one
+//- is linked (looked up) right before its action, i.e. after actions
+//- of the previous units: they may add symbols it needs or load objects
+//- (see voidc_object_file_load_to_jit_internal_helper)...
+//- Units defining anything but their action/init/term run as before.
 //---------------------------------------------------------------------
 void
-voidc_local_ctx_t::prepare_unit_action(int line, int column)
+voidc_local_ctx_t::run_unit_actions(const std::vector<LLVMMemoryBufferRef> &buffers)
 {
-    assert(voidc_global_ctx_t::target == voidc_global_ctx_t::voidc);    //- Sic!
+    auto &gctx = *voidc_global_ctx_t::voidc;
 
-    std::string tail = std::to_string(line) + "_" + std::to_string(column);
+    static const search_request_t unit_req[] =
+    {
+        { "voidc.init_func.", 16, 0 },
+        { "voidc.term_func.", 16, 0 },
 
-    std::string mod_name = "voidc.unit_module_" + tail;
-    std::string fun_name = "voidc.unit_action_" + tail;
+        { "voidc.unit_action_", 18, 0 },
 
-    module = LLVMModuleCreateWithNameInContext(mod_name.c_str(), global_ctx.llvm_ctx);
+        { 0, 0, 0 }
+    };
 
-    LLVMSetSourceFileName(module, filename.c_str(), filename.size());
+    auto run_one = [this](LLVMMemoryBufferRef buf)
+    {
+        unit_buffer = buf;
 
-    prepare_function(fun_name.c_str(), global_ctx.make_function_type(global_ctx.void_type, nullptr, 0, false));
-}
+        run_unit_action();
 
-//---------------------------------------------------------------------
-void
-voidc_local_ctx_t::finish_unit_action(void)
-{
-    assert(voidc_global_ctx_t::target == voidc_global_ctx_t::voidc);    //- Sic!
+        unit_buffer = nullptr;
+    };
 
-    finish_function();
+    size_t i = 0;
 
-    finish_module(module);
+    while(i < buffers.size())
+    {
+        //- Collect a batch [i, j) and add its objects...
 
-    //-------------------------------------------------------------
-    voidc_global_ctx_t::prepare_module_for_jit(module);
+        unit_jd_t ujd = {nullptr, nullptr, 0};
 
-    //-------------------------------------------------------------
-    char *msg = nullptr;
+        LLVMOrcResourceTrackerRef rt = nullptr;
 
-    auto err = LLVMTargetMachineEmitToMemoryBuffer(voidc_global_ctx_t::target_machine,
-                                                   module,
-                                                   LLVMObjectFile,
-                                                   &msg,
-                                                   &unit_buffer);
+        std::set<v_quark_t> names;
 
-    if (err)
-    {
-        printf("\n%s\n", msg);
+        std::vector<std::pair<size_t, object_lookup_t>> objects;       //- (unit, lookup)
 
-        LLVMDisposeMessage(msg);
+        size_t j = i;
 
-        abort();                //- Sic !!!
-    }
+        for (; j < buffers.size(); ++j)
+        {
+            auto buf = buffers[j];
 
-    assert(unit_buffer);
+            if (is_bitcode_buffer(buf))  continue;      //- Interpreted, in order
 
-    //-------------------------------------------------------------
-    LLVMDisposeModule(module);
+            bool ok = true;
 
-    vars = variables_t();       //- ?
-}
+            std::vector<v_quark_t> qs;
 
-//---------------------------------------------------------------------
-void
-voidc_local_ctx_t::run_unit_action(void)
-{
-    if (!unit_buffer) return;
+            for_each_defined_symbol(buf, [&](StringRef name)
+            {
+                name = demangle_symbol_name(name);
 
-    auto es = LLVMOrcLLJITGetExecutionSession(voidc_global_ctx_t::jit);
+                bool own = false;
 
-    auto &gctx = *voidc_global_ctx_t::voidc;
+                for (int k=0; unit_req[k].prefix; ++k)
+                {
+                    if (name_starts_with(name, StringRef(unit_req[k].prefix, unit_req[k].length)))  own = true;
+                }
 
-    std::string jd_name("voidc_unit_jd_" + std::to_string(gctx.jd_hash));
+                auto q = v_quark_from_string_n(name.data(), name.size());
 
-    gctx.jd_hash += 1;
+                if (!own  ||  names.count(q))  ok = false;
 
-    LLVMOrcJITDylibRef jd = nullptr;
+                qs.push_back(q);
+            });
 
-    LLVMOrcExecutionSessionCreateJITDylib(es, &jd, jd_name.c_str());
+            if (!ok)  break;
 
-    assert(jd);
+            names.insert(qs.begin(), qs.end());
 
-    setup_link_order(jd);
+            if (!rt)
+            {
+                ujd = unit_jd_acquire(gctx);
 
-    auto rt = LLVMOrcJITDylibCreateResourceTracker(jd);
+                rt = LLVMOrcJITDylibCreateResourceTracker(ujd.jd);
+            }
 
-    search_request_t req[] =
-    {
-        { "voidc.init_func.", 16, 0 },
-        { "voidc.term_func.", 16, 0 },
+            object_lookup_t ol;
 
-        { "voidc.unit_action_", 18, 0 },
+            add_object_file_to_rt(buf, rt, unit_req, false, ol);
 
-        { 0, 0, 0 }
-    };
+            objects.emplace_back(j, std::move(ol));
+        }
 
-    add_object_file_to_jd_with_rt(unit_buffer, jd, rt, req);
+        if (j == i)             //- Not for a batch...
+        {
+            run_one(buffers[i++]);
 
-    if (auto addr = req[0].addr)
-    {
-        void (*init_fun)() = (void (*)())addr;
+            continue;
+        }
 
-        init_fun();
-    }
+        //- Run the batch...
 
-    void (*unit_action)() = (void (*)())req[2].addr;
+        auto it = objects.begin();
 
-    unit_action();
+        for (size_t u = i; u < j; ++u)
+        {
+            if (it == objects.end()  ||  it->first != u)
+            {
+                run_one(buffers[u]);
 
-    if (auto addr = req[1].addr)
-    {
-        void (*term_fun)() = (void (*)())addr;
+                continue;
+            }
 
-        term_fun();
-    }
+            unit_action_counts[unit_action_count_native] += 1;
 
-    flush_unit_symbols();
+            if (ujd.ctx != this  ||  ujd.stamp != link_order_stamp)
+            {
+                setup_link_order(ujd.jd);
 
-    LLVMOrcResourceTrackerRemove(rt);
-    LLVMOrcReleaseResourceTracker(rt);      //- ?
+                ujd.ctx   = this;
+                ujd.stamp = link_order_stamp;
+            }
 
-    auto e2 = unwrap(voidc_global_ctx_t::jit)->getExecutionSession().removeJITDylib(*unwrap(jd));       //- WTF ?
+            search_request_t req[std::size(unit_req)];
 
-    fflush(stdout);     //- WTF?
-    fflush(stderr);     //- WTF?
+            std::copy(std::begin(unit_req), std::end(unit_req), req);
+
+            lookup_object_file_symbols(ujd.jd, (it++)->second, req);
+
+            call_unit_action(req);
+
+            flush_unit_symbols();
+
+            fflush(stdout);     //- WTF?
+            fflush(stderr);     //- WTF?
+        }
+
+        if (rt)
+        {
+            LLVMOrcResourceTrackerRemove(rt);
+            LLVMOrcReleaseResourceTracker(rt);      //- ?
+
+            unit_jd_pool.push_back(ujd);
+        }
+
+        i = j;
+    }
 }
 
 
@@ -2630,6 +3809,53 @@ voidc_verify_jit_module_optimized(bool f)
     verify_jit_module_optimized = f;
 }
 
+//---------------------------------------------------------------------
+int
+voidc_get_opt_level(bool unit_action)
+{
+    return voidc_global_ctx_t::get_opt_level(unit_action);
+}
+
+void
+voidc_set_opt_level(bool unit_action, int level)        //- Forced, -1 - not
+{
+    forced_opt_level[unit_action] = (level > 3 ? 3 : level);
+}
+
+//---------------------------------------------------------------------
+void
+voidc_enable_unit_interp(bool f)
+{
+    unit_interp_enabled = f;
+}
+
+void
+voidc_enable_lazy_modules(bool f)
+{
+    lazy_modules = f;
+}
+
+void
+voidc_set_compile_threads(int n)            //- 0 - auto, 1 - no partitioning (default)
+{
+    n = (n < 0 ? 0 : n);
+
+    if (n == compile_threads)  return;
+
+    compile_threads = n;
+
+    compile_pool_terminate();   //- Resized on demand
+}
+
+size_t
+voidc_get_unit_action_count(int kind)       //- See unit_action_count_*
+{
+    if (kind < 0  ||  kind >= unit_action_count_count)  return 0;
+
+    return  unit_action_counts[kind];
+}
+
+//---------------------------------------------------------------------
 void
 voidc_prepare_module_for_jit(LLVMModuleRef module)
 {
@@ -2740,9 +3966,37 @@ int skip_load = 0;
 void
 voidc_skip_object_file_load(int n) { skip_load += n; }
 
+void
+voidc_object_file_load_to_jit_group_helper(bool begin, bool is_local)
+{
+    //- Partitions of one module: skipped and loaded as a whole...
+
+    auto &grp = local_object_group();
+
+    if (begin)
+    {
+        if (!is_local  &&  skip_load > 0)
+        {
+            --skip_load;
+
+            grp.skipped = true;
+        }
+
+        object_group_begin();
+    }
+    else
+    {
+        object_group_end();
+
+        grp.skipped = false;
+    }
+}
+
 void
 voidc_object_file_load_to_jit_internal_helper(const char *buf, size_t len, bool is_local)
 {
+    if (local_object_group().skipped)  return;
+
     if (!is_local  &&  skip_load > 0)
     {
         --skip_load;
@@ -2752,12 +4006,33 @@ voidc_object_file_load_to_jit_internal_helper(const char *buf, size_t len, bool
 
     auto modbuf = LLVMCreateMemoryBufferWithMemoryRange(buf, len, "modbuf", 0);
 
-    if (is_local) voidc_add_local_object_file_to_jit(modbuf);
-    else          voidc_add_object_file_to_jit(modbuf);
+    if (is_bitcode_buffer(modbuf))  add_bitcode_module_to_jit(modbuf);
+    else if (is_local)              voidc_add_local_object_file_to_jit(modbuf);
+    else                            voidc_add_object_file_to_jit(modbuf);
 
     LLVMDisposeMemoryBuffer(modbuf);
 }
 
+void
+voidc_object_file_load_to_jit_record_helper(size_t index, bool is_local)
+{
+    auto &gctx = *voidc_global_ctx_t::voidc;
+    auto &lctx = static_cast<voidc_local_ctx_t &>(*gctx.local_ctx);
+
+    auto *records = lctx.module_records;
+
+    if (!records  ||  index >= records->views.size()  ||  !records->views[index].first)
+    {
+        printf("\nModule record %zu not found\n", index);
+
+        abort();            //- Sic !!!
+    }
+
+    auto &v = records->views[index];
+
+    voidc_object_file_load_to_jit_internal_helper(v.first, v.second, is_local);     //- Right from the binary
+}
+
 void
 voidc_compile_load_object_file_to_jit(LLVMMemoryBufferRef membuf, bool is_local, bool do_load)
 {
@@ -2769,36 +4044,69 @@ voidc_compile_load_object_file_to_jit(LLVMMemoryBufferRef membuf, bool is_local,
     auto membuf_ptr  = LLVMGetBufferStart(membuf);
     auto membuf_size = LLVMGetBufferSize(membuf);
 
-    auto membuf_const = LLVMConstString(membuf_ptr, membuf_size, 1);
-    auto membuf_const_type = LLVMTypeOf(membuf_const);
+    if (auto *records = lctx.module_records;  records  &&  records->put)
+    {
+        //- Separate record of the import binary, the action refers to it by index...
 
-    auto membuf_glob = LLVMAddGlobal(lctx.module, membuf_const_type, "membuf_g");
+        auto &data = records->owned.emplace_front(membuf_ptr, membuf_size);
 
-    LLVMSetLinkage(membuf_glob, LLVMPrivateLinkage);
+        size_t index = records->views.size();
 
-    LLVMSetInitializer(membuf_glob, membuf_const);
+        records->views.emplace_back(data.data(), data.size());
 
-    LLVMValueRef val[3];
+        records->put(records->put_aux, data.data(), data.size(), is_bitcode_buffer(membuf));
 
-    v_type_t    *t;
-    LLVMValueRef f;
+        LLVMValueRef val[2];
 
-    lctx.obtain_identifier(voidc_object_file_load_to_jit_internal_helper_q, t, f);
-    assert(f);
+        v_type_t    *t;
+        LLVMValueRef f;
 
-    val[0] = membuf_glob;
-    val[1] = LLVMConstInt(gctx.size_t_type->llvm_type(), membuf_size, 0);
-    val[2] = LLVMConstInt(gctx.bool_type->llvm_type(), is_local, 0);
+        lctx.obtain_identifier(voidc_object_file_load_to_jit_record_helper_q, t, f);
+        assert(f);
 
-    t = static_cast<v_type_pointer_t *>(t)->element_type();
+        val[0] = LLVMConstInt(gctx.size_t_type->llvm_type(), index, 0);
+        val[1] = LLVMConstInt(gctx.bool_type->llvm_type(), is_local, 0);
+
+        t = static_cast<v_type_pointer_t *>(t)->element_type();
+
+        LLVMBuildCall2(gctx.builder, t->llvm_type(), f, val, 2, "");
+    }
+    else
+    {
+        //- Embedded into the unit action itself...
+
+        auto membuf_const = LLVMConstString(membuf_ptr, membuf_size, 1);
+        auto membuf_const_type = LLVMTypeOf(membuf_const);
+
+        auto membuf_glob = LLVMAddGlobal(lctx.module, membuf_const_type, "membuf_g");
 
-    LLVMBuildCall2(gctx.builder, t->llvm_type(), f, val, 3, "");
+        LLVMSetLinkage(membuf_glob, LLVMPrivateLinkage);
+
+        LLVMSetInitializer(membuf_glob, membuf_const);
+
+        LLVMValueRef val[3];
+
+        v_type_t    *t;
+        LLVMValueRef f;
+
+        lctx.obtain_identifier(voidc_object_file_load_to_jit_internal_helper_q, t, f);
+        assert(f);
+
+        val[0] = membuf_glob;
+        val[1] = LLVMConstInt(gctx.size_t_type->llvm_type(), membuf_size, 0);
+        val[2] = LLVMConstInt(gctx.bool_type->llvm_type(), is_local, 0);
+
+        t = static_cast<v_type_pointer_t *>(t)->element_type();
+
+        LLVMBuildCall2(gctx.builder, t->llvm_type(), f, val, 3, "");
+    }
 
     //-----------------------------------------------------------------
     if (do_load)
     {
-        if (is_local) voidc_add_local_object_file_to_jit(membuf);
-        else          voidc_add_object_file_to_jit(membuf);
+        if (is_bitcode_buffer(membuf))  gctx.add_lazy_module_to_jit(membuf);
+        else if (is_local)              voidc_add_local_object_file_to_jit(membuf);
+        else                            voidc_add_object_file_to_jit(membuf);
     }
 }
 
@@ -2812,26 +4120,7 @@ voidc_compile_load_module_to_jit(LLVMModuleRef module, bool is_local, bool do_lo
 
     //- Emit module -> membuf
 
-    LLVMMemoryBufferRef membuf = nullptr;
-
-    char *msg = nullptr;
-
-    auto err = LLVMTargetMachineEmitToMemoryBuffer(voidc_global_ctx_t::target_machine,
-                                                   module,
-                                                   LLVMObjectFile,
-                                                   &msg,
-                                                   &membuf);
-
-    if (err)
-    {
-        printf("\n%s\n", msg);
-
-        LLVMDisposeMessage(msg);
-
-        abort();                //- Sic !!!
-    }
-
-    assert(membuf);
+    auto membuf = voidc_global_ctx_t::emit_object_file(module, voidc_global_ctx_t::get_opt_level(false));
 
     voidc_compile_load_object_file_to_jit(membuf, is_local, do_load);
 
@@ -2870,6 +4159,28 @@ load_object_file_helper(LLVMMemoryBufferRef membuf, bool is_local, bool do_load)
 }
 
 
+static void
+build_object_group_call(bool begin, bool is_local)
+{
+    auto &gctx = *voidc_global_ctx_t::voidc;
+    auto &lctx = static_cast<voidc_local_ctx_t &>(*gctx.local_ctx);
+
+    LLVMValueRef val[2];
+
+    v_type_t    *t;
+    LLVMValueRef f;
+
+    lctx.obtain_identifier(voidc_object_file_load_to_jit_group_helper_q, t, f);
+    assert(f);
+
+    val[0] = LLVMConstInt(gctx.bool_type->llvm_type(), begin, 0);
+    val[1] = LLVMConstInt(gctx.bool_type->llvm_type(), is_local, 0);
+
+    t = static_cast<v_type_pointer_t *>(t)->element_type();
+
+    LLVMBuildCall2(gctx.builder, t->llvm_type(), f, val, 2, "");
+}
+
 static void
 load_module_helper(LLVMModuleRef module, bool is_local, bool do_load)
 {
@@ -2880,7 +4191,23 @@ load_module_helper(LLVMModuleRef module, bool is_local, bool do_load)
 
     lctx.finish_module(module);
 
-    gctx.prepare_module_for_jit(module);
+    std::vector<LLVMMemoryBufferRef> membufs;
+
+    bool lazy = (lazy_modules  &&  !is_local  &&  module_can_be_lazy(*unwrap(module)));
+
+    if (lazy)
+    {
+        gctx.verify_module(module);
+
+        LLVMSetModuleDataLayout(module, gctx.data_layout);
+        LLVMSetTarget(module, voidc_triple);
+
+        membufs.push_back(LLVMWriteBitcodeToMemoryBuffer(module));      //- Not optimized (yet)
+    }
+    else
+    {
+        membufs = gctx.compile_module_for_jit(module);
+    }
 
     //- Generate unit ...
 
@@ -2892,7 +4219,28 @@ load_module_helper(LLVMModuleRef module, bool is_local, bool do_load)
 
     lctx.prepare_unit_action(0, 0);         //- line, column ?..
 
-    voidc_compile_load_module_to_jit(module, is_local, do_load);
+    bool group = (membufs.size() > 1);      //- Partitions
+
+    if (group)
+    {
+        build_object_group_call(true, is_local);
+
+        if (do_load)  object_group_begin();
+    }
+
+    for (auto membuf : membufs)
+    {
+        voidc_compile_load_object_file_to_jit(membuf, is_local, do_load);
+    }
+
+    if (group)
+    {
+        build_object_group_call(false, is_local);
+
+        if (do_load)  object_group_end();
+    }
+
+    for (auto membuf : membufs)  LLVMDisposeMemoryBuffer(membuf);       //- After the group's lookups
 
 //  base_global_ctx_t::debug_print_module = 1;
 
@@ -14,10 +14,12 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <forward_list>
 #include <deque>
 #include <utility>
 #include <tuple>
+#include <functional>
 
 #include <immer/map.hpp>
 
@@ -362,6 +364,19 @@ private:
 };
 
 
+//---------------------------------------------------------------------
+//- Symbol index: raw name -> dylib and value (nullptr - not looked up
+//- yet, see voidc_local_ctx_t::find_symbol_value)
+//---------------------------------------------------------------------
+struct voidc_symbol_entry_t
+{
+    LLVMOrcJITDylibRef jd;
+    void              *value;
+};
+
+using voidc_symbol_index_t = std::unordered_map<v_quark_t, voidc_symbol_entry_t>;
+
+
 //---------------------------------------------------------------------
 //- Voidc template Context
 //---------------------------------------------------------------------
@@ -393,6 +408,8 @@ public:
 public:
     std::deque<LLVMOrcJITDylibRef> deque_jd;
 
+    voidc_symbol_index_t symbol_index;      //- For deque_jd and base_jd
+
 public:
     void setup_link_order(LLVMOrcJITDylibRef jd);
 };
@@ -433,7 +450,25 @@ public:
     VOIDC_DLLEXPORT static LLVMTargetMachineRef target_machine;
 
 public:
-    static void prepare_module_for_jit(LLVMModuleRef module);
+    static void prepare_module_for_jit(LLVMModuleRef module);                   //- Module level
+    static void prepare_module_for_jit(LLVMModuleRef module, int opt_level);
+
+    static int get_opt_level(bool unit_action);
+
+    static LLVMTargetMachineRef get_target_machine(int opt_level);
+
+    static LLVMMemoryBufferRef emit_object_file(LLVMModuleRef module, int opt_level);      //- Object file
+
+    static std::vector<LLVMMemoryBufferRef> compile_module_for_jit(LLVMModuleRef module);  //- Prepare + emit, maybe in parallel
+
+private:
+    static class compile_pipeline_t *compile_pipeline;          //- Long-lived, see voidc_compile_pipeline.h
+
+public:
+    void add_lazy_module_to_jit(LLVMMemoryBufferRef bitcode);   //- Compile on demand, see voidc_target.cpp
+
+private:
+    static class lazy_layer_t *lazy_layer;                      //- See voidc_lazy_layer.h
 
 public:
     v_type_t * const type_type;
@@ -467,7 +502,42 @@ public:
     void finish_unit_action(void);
     void run_unit_action(void);
 
+    void run_unit_actions(const std::vector<LLVMMemoryBufferRef> &buffers);     //- Replay, in order
+
     LLVMMemoryBufferRef unit_buffer = nullptr;
+
+public:
+    //- Module objects as separate records of the import binary (see
+    //- v_import_helper): unit actions refer to them by index...
+
+    struct module_records_t
+    {
+        std::vector<std::pair<const char *, size_t>> views;        //- By index
+
+        std::forward_list<std::string> owned;           //- Compiled ones
+
+        void (*put)(void *aux, const char *buf, size_t len, bool lazy) = nullptr;      //- Compile only
+        void  *put_aux = nullptr;
+    };
+
+    module_records_t *module_records = nullptr;
+
+public:
+    //- Partitions of one module are loaded as a group (see
+    //- voidc_object_file_load_to_jit_group_helper)...
+
+    struct object_group_t
+    {
+        int depth = 0;
+
+        std::vector<std::function<void()>> pending;     //- Deferred lookups
+
+        LLVMOrcJITDylibRef jd = nullptr;                //- Shared by the group
+
+        bool skipped = false;                           //- See voidc_skip_object_file_load
+    };
+
+    object_group_t object_group;
 };
 
 
@@ -276,7 +276,31 @@ voidc_types_ctx_t::voidc_types_ctx_t(LLVMContextRef ctx, size_t int_size, size_t
 
 voidc_types_ctx_t::~voidc_types_ctx_t()
 {
-    //- ...
+    //- Memory goes with the arena...
+
+    destroy_types(int_types);
+    destroy_types(uint_types);
+
+    destroy_types(function_types);
+
+    destroy_types(pointer_types);
+    destroy_types(reference_types);
+
+    destroy_types(named_struct_types);
+    destroy_types(anon_struct_types);
+
+    destroy_types(array_types);
+
+    destroy_types(vector_types);
+    destroy_types(svector_types);
+
+    destroy_types(generic_types);
+
+    destroy_types(number_args);
+    destroy_types(string_args);
+    destroy_types(quark_args);
+    destroy_types(type_args);
+    destroy_types(cons_args);
 }
 
 
@@ -319,20 +343,67 @@ v_type_f128_t * voidc_types_ctx_t::make_f128_type(void) { return make_type_helpe
 
 
 //---------------------------------------------------------------------
-template <typename T, typename K> inline
+//- Structural hashes (pointers are "values" here - types are unique)
+//---------------------------------------------------------------------
+static inline
+size_t
+types_hash(size_t h, uint64_t v)
+{
+    v ^= v >> 33;   v *= 0xff51afd7ed558ccdULL;         //- "fmix64"
+    v ^= v >> 33;   v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+
+    return  (h ^ v) * 0x100000001b3ULL + 0x9e3779b97f4a7c15ULL;
+}
+
+template<typename E>
+static inline
+size_t
+types_hash(size_t h, E const *items, unsigned count)
+{
+    h = types_hash(h, count);
+
+    for (unsigned i=0; i<count; ++i)  h = types_hash(h, uint64_t(uintptr_t(items[i])));
+
+    return h;
+}
+
+template<typename E>
+static inline
+bool
+types_list_equal(const voidc_types_list_t<E> &list, E const *items, unsigned count)
+{
+    return  list.count == count  &&  std::equal(items, items+count, list.items);
+}
+
+
+//---------------------------------------------------------------------
+template <typename T, typename K, typename Eq, typename MK> inline
 T *
-voidc_types_ctx_t::make_type_helper(types_map_t<T, K> &tmap, const K &key)
+voidc_types_ctx_t::make_type_helper(types_table_t<T, K> &table, size_t hash, Eq &&eq, MK &&make_key)
 {
-    auto [it, nx] = tmap.try_emplace(key, nullptr);
+    if (auto *t = table.find(hash, eq))  return t;
 
-    if (nx)
-    {
-        auto t = new T(*this, it->first);
+    auto *key = new(arena.allocate(sizeof(K), alignof(K))) K(make_key());
 
-        it->second.reset(t);
-    }
+    auto *t = new(arena.allocate(sizeof(T), alignof(T))) T(*this, *key);
+
+    table.insert(hash, key, t);
+
+    return t;
+}
+
+//---------------------------------------------------------------------
+template <typename T, typename K> inline
+void
+voidc_types_ctx_t::destroy_types(types_table_t<T, K> &table)
+{
+    table.for_each([](auto &s)
+    {
+        s.type->~T();
 
-    return check_cached_llvm_type(it->second.get());
+        s.key->~K();
+    });
 }
 
 
@@ -340,13 +411,21 @@ voidc_types_ctx_t::make_type_helper(types_map_t<T, K> &tmap, const K &key)
 v_type_int_t *
 voidc_types_ctx_t::make_int_type(unsigned bits)
 {
-    return make_type_helper(int_types, bits);
+    auto *t = make_type_helper(int_types, types_hash(0, bits),
+                               [bits](unsigned k) { return k == bits; },
+                               [bits]() { return bits; });
+
+    return check_cached_llvm_type(t);
 }
 
 v_type_uint_t *
 voidc_types_ctx_t::make_uint_type(unsigned bits)
 {
-    return make_type_helper(uint_types, bits);
+    auto *t = make_type_helper(uint_types, types_hash(0, bits),
+                               [bits](unsigned k) { return k == bits; },
+                               [bits]() { return bits; });
+
+    return check_cached_llvm_type(t);
 }
 
 
@@ -364,32 +443,49 @@ voidc_types_ctx_t::make_function_type(v_type_t *ret, v_type_t * const *args, uns
 
     assert((std::all_of(ft_data, ft_data+N, [this](auto t){ return &t->context == this; })));
 
-    v_type_function_t::key_t key = { {ft_data, ft_data+N}, var_arg };
+    using key_t = v_type_function_t::key_t;
+
+    size_t hash = types_hash(types_hash(0, ft_data, N), var_arg);
 
-    return make_type_helper(function_types, key);
+    auto *t = make_type_helper(function_types, hash,
+                               [&](const key_t &k) { return k.second == var_arg  &&  types_list_equal(k.first, ft_data, N); },
+                               [&]() { return key_t{arena.make_list(ft_data, N), var_arg}; });
+
+    return check_cached_llvm_type(t);
 }
 
 
 //---------------------------------------------------------------------
-v_type_pointer_t *
-voidc_types_ctx_t::make_pointer_type(v_type_t *et, unsigned addr_space)
+template <typename T> inline
+T *
+voidc_types_ctx_t::make_type_helper(types_table_t<T> &table, v_type_t *et, uint64_t num)
 {
     assert(&et->context == this);
 
-    v_type_pointer_t::key_t key = { et, addr_space };
+    using key_t = typename T::key_t;
+
+    size_t hash = types_hash(types_hash(0, uint64_t(uintptr_t(et))), num);
+
+    auto *t = make_type_helper(table, hash,
+                               [et, num](const key_t &k) { return k.first == et  &&  k.second == num; },
+                               [et, num]() { return key_t(et, typename key_t::second_type(num)); });
+
+    return check_cached_llvm_type(t);
+}
+
 
-    return make_type_helper(pointer_types, key);
+//---------------------------------------------------------------------
+v_type_pointer_t *
+voidc_types_ctx_t::make_pointer_type(v_type_t *et, unsigned addr_space)
+{
+    return make_type_helper(pointer_types, et, addr_space);
 }
 
 //---------------------------------------------------------------------
 v_type_reference_t *
 voidc_types_ctx_t::make_reference_type(v_type_t *et, unsigned addr_space)
 {
-    assert(&et->context == this);
-
-    v_type_reference_t::key_t key = { et, addr_space };
-
-    return make_type_helper(reference_types, key);
+    return make_type_helper(reference_types, et, addr_space);
 }
 
 
@@ -397,7 +493,11 @@ voidc_types_ctx_t::make_reference_type(v_type_t *et, unsigned addr_space)
 v_type_struct_t *
 voidc_types_ctx_t::make_struct_type(v_quark_t name)
 {
-    return make_type_helper(named_struct_types, name);
+    auto *t = make_type_helper(named_struct_types, types_hash(0, name),
+                               [name](v_quark_t k) { return k == name; },
+                               [name]() { return name; });
+
+    return check_cached_llvm_type(t);
 }
 
 v_type_struct_t *
@@ -405,9 +505,15 @@ voidc_types_ctx_t::make_struct_type(v_type_t * const *elts, unsigned count, bool
 {
     assert((std::all_of(elts, elts+count, [this](auto t){ return &t->context == this; })));
 
-    v_type_struct_t::body_key_t key = { {elts, elts+count}, packed };
+    using key_t = v_type_struct_t::body_key_t;
+
+    size_t hash = types_hash(types_hash(0, elts, count), packed);
+
+    auto *t = make_type_helper(anon_struct_types, hash,
+                               [&](const key_t &k) { return k.second == packed  &&  types_list_equal(k.first, elts, count); },
+                               [&]() { return key_t{arena.make_list(elts, count), packed}; });
 
-    return make_type_helper(anon_struct_types, key);
+    return check_cached_llvm_type(t);
 }
 
 
@@ -415,11 +521,7 @@ voidc_types_ctx_t::make_struct_type(v_type_t * const *elts, unsigned count, bool
 v_type_array_t *
 voidc_types_ctx_t::make_array_type(v_type_t *et, uint64_t count)
 {
-    assert(&et->context == this);
-
-    v_type_array_t::key_t key = { et, count };
-
-    return make_type_helper(array_types, key);
+    return make_type_helper(array_types, et, count);
 }
 
 
@@ -427,21 +529,13 @@ voidc_types_ctx_t::make_array_type(v_type_t *et, uint64_t count)
 v_type_vector_t *
 voidc_types_ctx_t::make_vector_type(v_type_t *et, unsigned count)
 {
-    assert(&et->context == this);
-
-    v_type_vector_t::key_t key = { et, count };
-
-    return make_type_helper(vector_types, key);
+    return make_type_helper(vector_types, et, count);
 }
 
 v_type_svector_t *
 voidc_types_ctx_t::make_svector_type(v_type_t *et, unsigned count)
 {
-    assert(&et->context == this);
-
-    v_type_svector_t::key_t key = { et, count };
-
-    return make_type_helper(svector_types, key);
+    return make_type_helper(svector_types, et, count);
 }
 
 
@@ -451,45 +545,42 @@ voidc_types_ctx_t::make_generic_type(v_quark_t cons, v_type_generic_t::arg_t * c
 {
     assert((std::all_of(args, args+count, [this](auto a){ return &a->context == this; })));
 
-    v_type_generic_t::key_t key = { cons, {args, args+count} };
-
-    return make_type_helper(generic_types, key);
-}
-
-//---------------------------------------------------------------------
-template <typename T, typename K> inline
-T *
-voidc_types_ctx_t::make_arg_helper(types_map_t<T, K> &tmap, const K &key)
-{
-    auto [it, nx] = tmap.try_emplace(key, nullptr);
+    using key_t = v_type_generic_t::key_t;
 
-    if (nx)
-    {
-        auto t = new T(*this, it->first);
+    size_t hash = types_hash(types_hash(0, cons), args, count);
 
-        it->second.reset(t);
-    }
+    auto *t = make_type_helper(generic_types, hash,
+                               [&](const key_t &k) { return k.first == cons  &&  types_list_equal(k.second, args, count); },
+                               [&]() { return key_t{cons, arena.make_list(args, count)}; });
 
-    return  it->second.get();
+    return check_cached_llvm_type(t);
 }
 
 //---------------------------------------------------------------------
 v_type_generic_t::arg_number_t *
 voidc_types_ctx_t::make_number_arg(uint64_t num)
 {
-    return make_arg_helper(number_args, num);
+    return make_type_helper(number_args, types_hash(0, num),
+                            [num](uint64_t k) { return k == num; },
+                            [num]() { return num; });
 }
 
 v_type_generic_t::arg_string_t *
 voidc_types_ctx_t::make_string_arg(const std::string &str)
 {
-    return make_arg_helper(string_args, str);
+    size_t hash = types_hash(0, std::hash<std::string>()(str));
+
+    return make_type_helper(string_args, hash,
+                            [&str](const std::string &k) { return k == str; },
+                            [&str]() { return str; });
 }
 
 v_type_generic_t::arg_quark_t *
 voidc_types_ctx_t::make_quark_arg(v_quark_t q)
 {
-    return make_arg_helper(quark_args, q);
+    return make_type_helper(quark_args, types_hash(0, q),
+                            [q](v_quark_t k) { return k == q; },
+                            [q]() { return q; });
 }
 
 v_type_generic_t::arg_type_t *
@@ -497,7 +588,9 @@ voidc_types_ctx_t::make_type_arg(v_type_t *t)
 {
     assert(&t->context == this);
 
-    return make_arg_helper(type_args, t);
+    return make_type_helper(type_args, types_hash(0, uint64_t(uintptr_t(t))),
+                            [t](v_type_t *k) { return k == t; },
+                            [t]() { return t; });
 }
 
 v_type_generic_t::arg_cons_t *
@@ -505,9 +598,13 @@ voidc_types_ctx_t::make_cons_arg(v_quark_t cons, v_type_generic_t::arg_t * const
 {
     assert((std::all_of(args, args+count, [this](auto a){ return &a->context == this; })));
 
-    v_type_generic_t::arg_cons_t::key_t key = { cons, {args, args+count} };
+    using key_t = v_type_generic_t::arg_cons_t::key_t;
+
+    size_t hash = types_hash(types_hash(0, cons), args, count);
 
-    return make_arg_helper(cons_args, key);
+    return make_type_helper(cons_args, hash,
+                            [&](const key_t &k) { return k.first == cons  &&  types_list_equal(k.second, args, count); },
+                            [&]() { return key_t{cons, arena.make_list(args, count)}; });
 }
 
 
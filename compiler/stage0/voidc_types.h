@@ -9,7 +9,9 @@
 #include "voidc_dllexport.h"
 
 #include <cassert>
+#include <cstdint>
 #include <utility>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <memory>
@@ -24,6 +26,28 @@
 class voidc_types_ctx_t;
 
 
+//---------------------------------------------------------------------
+//- Immutable list (in the arena of a types context) - for keys...
+//---------------------------------------------------------------------
+template<typename E>
+struct voidc_types_list_t
+{
+    E const *items = nullptr;
+
+    unsigned count = 0;
+
+public:
+    size_t size(void) const { return count; }
+
+    E const *data(void) const { return items; }
+
+    E const &operator[](size_t i) const { return items[i]; }
+
+    E const *begin(void) const { return items; }
+    E const *end(void)   const { return items + count; }
+};
+
+
 //---------------------------------------------------------------------
 //- Base class for voidc`s own types
 //---------------------------------------------------------------------
@@ -192,7 +216,7 @@ class v_type_function_t : public v_type_tag_t<v_type_t, v_type_t::k_function>
 {
     friend class voidc_types_ctx_t;
 
-    using key_t = std::pair<std::vector<v_type_t *>, bool>;
+    using key_t = std::pair<voidc_types_list_t<v_type_t *>, bool>;
 
     const key_t &key;
 
@@ -271,7 +295,7 @@ class v_type_struct_t : public v_type_tag_t<v_type_t, v_type_t::k_struct>
     friend class voidc_types_ctx_t;
 
     using name_key_t = v_quark_t;
-    using body_key_t = std::pair<std::vector<v_type_t *>, bool>;
+    using body_key_t = std::pair<voidc_types_list_t<v_type_t *>, bool>;
 
     const name_key_t *name_key = nullptr;
     const body_key_t *body_key = nullptr;
@@ -394,7 +418,7 @@ public:
 private:
     friend class voidc_types_ctx_t;
 
-    using key_t = std::pair<v_quark_t, std::vector<arg_t *>>;
+    using key_t = std::pair<v_quark_t, voidc_types_list_t<arg_t *>>;
 
     const key_t &key;
 
@@ -554,7 +578,7 @@ class v_type_generic_t::arg_cons_t : public v_type_generic_arg_tag_t<arg_t::k_co
 {
     friend class voidc_types_ctx_t;
 
-    using key_t = std::pair<v_quark_t, std::vector<arg_t *>>;
+    using key_t = std::pair<v_quark_t, voidc_types_list_t<arg_t *>>;
 
     const key_t &key;
 
@@ -672,38 +696,160 @@ protected:
     template <typename T> inline
     T *make_type_helper(std::unique_ptr<T> &tptr);
 
+    //- Arena: types, their keys and key lists - never moved, freed at once
+
+    class arena_t
+    {
+    public:
+        arena_t() = default;
+        ~arena_t() = default;
+
+        arena_t(const arena_t &) = delete;
+        arena_t &operator=(const arena_t &) = delete;
+
+    public:
+        void *allocate(size_t size, size_t align)
+        {
+            auto p = (uintptr_t(cur) + (align-1)) & ~uintptr_t(align-1);
+
+            if (!cur  ||  p + size > uintptr_t(end))
+            {
+                size_t block_size = std::max<size_t>(size + align, 16*1024);
+
+                blocks.emplace_back(new char[block_size]);
+
+                cur = blocks.back().get();
+                end = cur + block_size;
+
+                p = (uintptr_t(cur) + (align-1)) & ~uintptr_t(align-1);
+            }
+
+            cur = (char *)(p + size);
+
+            return (void *)p;
+        }
+
+        template<typename E>
+        voidc_types_list_t<E> make_list(E const *items, unsigned count)
+        {
+            auto *data = (E *)allocate(count*sizeof(E) + 1, alignof(E));       //- Sic! (+1)
+
+            std::copy_n(items, count, data);
+
+            return {data, count};
+        }
+
+    private:
+        std::vector<std::unique_ptr<char[]>> blocks;
+
+        char *cur = nullptr;
+        char *end = nullptr;
+    };
+
+    arena_t arena;
+
+    //- Open addressing (linear probing), hashes are stored...
+
     template <typename T, typename K = typename T::key_t>
-    using types_map_t = std::map<K, std::unique_ptr<T>>;
+    class types_table_t
+    {
+    public:
+        struct slot_t
+        {
+            size_t   hash;
+            const K *key;
+            T       *type;          //- nullptr - empty slot
+        };
+
+    public:
+        template<typename Eq>
+        T *find(size_t hash, Eq &&eq) const
+        {
+            if (slots.empty())  return nullptr;
+
+            size_t mask = slots.size() - 1;
+
+            for (size_t i = hash & mask; ; i = (i+1) & mask)
+            {
+                auto &s = slots[i];
+
+                if (!s.type)  return nullptr;
+
+                if (s.hash == hash  &&  eq(*s.key))  return s.type;
+            }
+        }
+
+        void insert(size_t hash, const K *key, T *type)
+        {
+            if (4*(count+1) > 3*slots.size())       //- Load factor 3/4
+            {
+                std::vector<slot_t> old(std::max<size_t>(16, 2*slots.size()), slot_t{0, nullptr, nullptr});
+
+                std::swap(slots, old);
 
-    template <typename T, typename K = typename T::key_t> inline
-    T *make_type_helper(types_map_t<T, K> &tmap, const K &key);
+                for (auto &s : old)  if (s.type)  place(s);
+            }
+
+            place({hash, key, type});
+
+            count += 1;
+        }
+
+        template<typename F>
+        void for_each(F &&f) const
+        {
+            for (auto &s : slots)  if (s.type)  f(s);
+        }
+
+    private:
+        std::vector<slot_t> slots;
+
+        size_t count = 0;
+
+        void place(const slot_t &slot)
+        {
+            size_t mask = slots.size() - 1;
+
+            size_t i = slot.hash & mask;
+
+            while (slots[i].type)  i = (i+1) & mask;
+
+            slots[i] = slot;
+        }
+    };
+
+    template <typename T, typename K, typename Eq, typename MK> inline
+    T *make_type_helper(types_table_t<T, K> &table, size_t hash, Eq &&eq, MK &&make_key);
+
+    template <typename T> inline
+    T *make_type_helper(types_table_t<T> &table, v_type_t *et, uint64_t num);      //- (type, number) keys
 
-    types_map_t<v_type_int_t,  unsigned> int_types;
-    types_map_t<v_type_uint_t, unsigned> uint_types;
+    template <typename T, typename K> inline
+    void destroy_types(types_table_t<T, K> &table);
 
-    types_map_t<v_type_function_t> function_types;
+    types_table_t<v_type_int_t,  unsigned> int_types;
+    types_table_t<v_type_uint_t, unsigned> uint_types;
 
-    types_map_t<v_type_pointer_t>   pointer_types;
-    types_map_t<v_type_reference_t> reference_types;
+    types_table_t<v_type_function_t> function_types;
 
-    types_map_t<v_type_struct_t, v_type_struct_t::name_key_t> named_struct_types;
-    types_map_t<v_type_struct_t, v_type_struct_t::body_key_t> anon_struct_types;
+    types_table_t<v_type_pointer_t>   pointer_types;
+    types_table_t<v_type_reference_t> reference_types;
 
-    types_map_t<v_type_array_t> array_types;
+    types_table_t<v_type_struct_t, v_type_struct_t::name_key_t> named_struct_types;
+    types_table_t<v_type_struct_t, v_type_struct_t::body_key_t> anon_struct_types;
 
-    types_map_t<v_type_vector_t>  vector_types;
-    types_map_t<v_type_svector_t> svector_types;
+    types_table_t<v_type_array_t> array_types;
 
-    types_map_t<v_type_generic_t> generic_types;
+    types_table_t<v_type_vector_t>  vector_types;
+    types_table_t<v_type_svector_t> svector_types;
 
-    template <typename T, typename K = typename T::key_t> inline
-    T *make_arg_helper(types_map_t<T, K> &tmap, const K &key);
+    types_table_t<v_type_generic_t> generic_types;
 
-    types_map_t<v_type_generic_t::arg_number_t>  number_args;
-    types_map_t<v_type_generic_t::arg_string_t>  string_args;
-    types_map_t<v_type_generic_t::arg_quark_t>   quark_args;
-    types_map_t<v_type_generic_t::arg_type_t>    type_args;
-    types_map_t<v_type_generic_t::arg_cons_t>    cons_args;
+    types_table_t<v_type_generic_t::arg_number_t>  number_args;
+    types_table_t<v_type_generic_t::arg_string_t>  string_args;
+    types_table_t<v_type_generic_t::arg_quark_t>   quark_args;
+    types_table_t<v_type_generic_t::arg_type_t>    type_args;
+    types_table_t<v_type_generic_t::arg_cons_t>    cons_args;
 
 public:
     hook_initialize_t get_initialize_hook(int k, void **paux);
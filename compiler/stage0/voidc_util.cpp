@@ -17,6 +17,7 @@
 #include <llvm-c/Core.h>
 
 #include <immer/flex_vector.hpp>
+#include <immer/flex_vector_transient.hpp>
 
 
 //---------------------------------------------------------------------
@@ -395,7 +396,7 @@ void static_initialize(void)
 
     generic_list_type = vctx.make_struct_type(q("v_ast_generic_list_t"));
 
-    lookup_overload_q = q("voidc.hook_lookup_overload");
+    lookup_overload_q = v_static_quark_voidc_hook_lookup_overload;
 
 #define DEF_U(name, num) \
     auto name##_q = q("v_" #name); \
@@ -676,7 +677,11 @@ v_util_make_list_util_list_impl(util_list_t *ret, const std::any *items, size_t
 void
 v_util_list_append_util_list_impl(util_list_t *ret, const util_list_t *list, const std::any *items, size_t count)
 {
-    (*ret) = std::make_shared<const util_list_data_t>(**list + util_list_data_t(items, items+count));
+    auto t = (*list)->transient();          //- No temporary list to concatenate
+
+    for (size_t i=0; i<count; ++i)  t.push_back(items[i]);
+
+    (*ret) = std::make_shared<const util_list_data_t>(t.persistent());
 }
 
 size_t
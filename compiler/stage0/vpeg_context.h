@@ -92,6 +92,14 @@ public:
 public:
     std::string take_string(size_t from, size_t to) const;
 
+    void fill_buffer(size_t size)           //- Read input up to "size" characters
+    {
+        while (buffer.size() < size)
+        {
+            buffer = buffer.push_back(read_character());
+        }
+    }
+
 public:
     bool expect(char32_t c)
     {
@@ -112,6 +120,9 @@ public:
 public:     //- ?...
     std::map<std::tuple<size_t, v_quark_t>, std::pair<std::any, state_t>> memo;
 
+public:
+    size_t impure_actions = 0;      //- Calls, see grammar_data_t::is_action_pure
+
 public:
     size_t get_line_column(size_t pos, size_t *column) const;
 
@@ -14,6 +14,9 @@
 
 #include <cstdio>
 #include <functional>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
 
 
 //---------------------------------------------------------------------
@@ -95,8 +98,8 @@ grammar_parse_default(void *, std::any *pret, grammar_t *pgrm, v_quark_t q_name,
 
         if (auto *ast = v_ast_std_any_get_base(&ret))
         {
-            static const v_quark_t pos_start_q = v_quark_from_string("pos_start");
-            static const v_quark_t pos_end_q   = v_quark_from_string("pos_end");
+            constexpr v_quark_t pos_start_q = v_static_quark_pos_start;
+            constexpr v_quark_t pos_end_q   = v_static_quark_pos_end;
 
             auto &props = (*ast)->properties;
 
@@ -168,6 +171,281 @@ grammar_data_t::set_parse_hook(grammar_parse_t fun, void *aux) const
 }
 
 
+//---------------------------------------------------------------------
+static std::unordered_set<grammar_action_fun_t> pure_actions;
+
+void
+grammar_data_t::set_action_pure(grammar_action_fun_t fun)
+{
+    pure_actions.insert(fun);
+}
+
+bool
+grammar_data_t::is_action_pure(grammar_action_fun_t fun)
+{
+    return  (pure_actions.count(fun) != 0);
+}
+
+
+//---------------------------------------------------------------------
+//- Fingerprint
+//---------------------------------------------------------------------
+//- Must be stable across runs: quarks are hashed by their strings,
+//- maps are combined order-independently (their order depends on quark
+//- ids), functions and pointers are not hashed at all - actions count
+//- by name, values by name and type (contents for strings only)...
+//---------------------------------------------------------------------
+namespace
+{
+
+struct fp_hasher_t
+{
+    uint64_t h = 0xcbf29ce484222325ULL;         //- FNV-1a
+
+    void add(const void *data, size_t size)
+    {
+        auto *p = (const unsigned char *)data;
+
+        for (size_t i=0; i<size; ++i)
+        {
+            h ^= p[i];
+            h *= 0x100000001b3ULL;
+        }
+    }
+
+    void add_u64(uint64_t v)   { add(&v, sizeof(v)); }
+
+    void add_str(const char *str, size_t len)
+    {
+        add_u64(len);
+        add(str, len);
+    }
+
+    void add_str(const std::string &str)  { add_str(str.data(), str.size()); }
+
+    void add_quark(v_quark_t q)
+    {
+        size_t len = 0;
+
+        auto *str = v_quark_to_string_view(q, &len);
+
+        if (str)  add_str(str, len);
+        else      add_u64(uint64_t(-1));
+    }
+};
+
+inline uint64_t
+fp_mix(uint64_t x)              //- splitmix64 finalizer
+{
+    x ^= x >> 30;   x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;   x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+
+    return x;
+}
+
+//---------------------------------------------------------------------
+struct fp_parsers_t
+{
+    std::unordered_map<const void *, uint64_t> memo;        //- Shared subtrees...
+
+    uint64_t argument(const argument_t &arg)
+    {
+        fp_hasher_t fh;
+
+        fh.add_u64(arg->kind());
+
+        switch(arg->kind())
+        {
+        case argument_data_t::k_identifier:
+            fh.add_quark(static_cast<const identifier_argument_data_t &>(*arg).q_ident);
+            break;
+
+        case argument_data_t::k_backref:
+            {   auto &a = static_cast<const backref_argument_data_t &>(*arg);
+
+                fh.add_u64(a.number);
+                fh.add_u64(a.b_kind);
+            }
+            break;
+
+        case argument_data_t::k_integer:
+            fh.add_u64(static_cast<const integer_argument_data_t &>(*arg).number);
+            break;
+
+        case argument_data_t::k_literal:
+            fh.add_str(static_cast<const literal_argument_data_t &>(*arg).utf8);
+            break;
+
+        case argument_data_t::k_character:
+            fh.add_u64(static_cast<const character_argument_data_t &>(*arg).ucs4);
+            break;
+        }
+
+        return fh.h;
+    }
+
+    uint64_t action(const action_t &act)
+    {
+        fp_hasher_t fh;
+
+        fh.add_u64(act->kind());
+
+        switch(act->kind())
+        {
+        case action_data_t::k_call:
+            {   auto &a = static_cast<const call_action_data_t &>(*act);
+
+                fh.add_quark(a.q_fun);
+
+                fh.add_u64(a.args.size());
+
+                for (auto &it : a.args)  fh.add_u64(argument(it));
+            }
+            break;
+
+        case action_data_t::k_return:
+            fh.add_u64(argument(static_cast<const return_action_data_t &>(*act).arg));
+            break;
+        }
+
+        return fh.h;
+    }
+
+    uint64_t parser(const parser_t &par)
+    {
+        if (auto it = memo.find(par.get());  it != memo.end())  return it->second;
+
+        fp_hasher_t fh;
+
+        auto kind = par->kind();
+
+        fh.add_u64(kind);
+
+        switch(kind)
+        {
+        case parser_data_t::k_catch_variable:
+            fh.add_quark(static_cast<const catch_variable_parser_data_t &>(*par).q_name);
+            break;
+
+        case parser_data_t::k_identifier:
+            fh.add_quark(static_cast<const identifier_parser_data_t &>(*par).q_ident);
+            break;
+
+        case parser_data_t::k_backref:
+            fh.add_u64(static_cast<const backref_parser_data_t &>(*par).number);
+            break;
+
+        case parser_data_t::k_action:
+            fh.add_u64(action(static_cast<const action_parser_data_t &>(*par).action));
+            break;
+
+        case parser_data_t::k_literal:
+            fh.add_str(static_cast<const literal_parser_data_t &>(*par).utf8);
+            break;
+
+        case parser_data_t::k_character:
+            fh.add_u64(static_cast<const character_parser_data_t &>(*par).ucs4);
+            break;
+
+        case parser_data_t::k_class:
+            {   auto &ranges = static_cast<const class_parser_data_t &>(*par).ranges;
+
+                fh.add_u64(ranges.size());
+
+                for (auto &r : ranges)
+                {
+                    fh.add_u64(r[0]);
+                    fh.add_u64(r[1]);
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        {   size_t count = par->parsers_count();
+
+            auto *parsers = par->get_parsers();
+
+            fh.add_u64(count);
+
+            for (size_t i=0; i<count; ++i)  fh.add_u64(parser(parsers[i]));
+        }
+
+        memo[par.get()] = fh.h;
+
+        return fh.h;
+    }
+};
+
+}   //- namespace
+
+
+//-----------------------------------------------------------------
+uint64_t
+grammar_data_t::fingerprint(void) const
+{
+    if (auto fp = fingerprint_memo.load(std::memory_order_relaxed))  return fp;
+
+    fp_parsers_t fpp;
+
+    uint64_t sum_p = 0;
+    uint64_t sum_a = 0;
+    uint64_t sum_v = 0;
+
+    for (auto &[q, pl] : parsers)
+    {
+        fp_hasher_t fh;
+
+        fh.add_quark(q);
+        fh.add_u64(fpp.parser(pl.first));
+        fh.add_u64(pl.second);
+
+        sum_p += fp_mix(fh.h);
+    }
+
+    for (auto &it : actions)
+    {
+        fp_hasher_t fh;
+
+        fh.add_quark(it.first);
+
+        sum_a += fp_mix(fh.h);
+    }
+
+    for (auto &[q, v] : values)
+    {
+        fp_hasher_t fh;
+
+        fh.add_quark(q);
+
+        fh.add_str(v.type().name());
+
+        if (auto *str = std::any_cast<std::string>(&v))  fh.add_str(*str);
+
+        sum_v += fp_mix(fh.h);
+    }
+
+    fp_hasher_t fh;
+
+    fh.add_u64(sum_p);
+    fh.add_u64(sum_a);
+    fh.add_u64(sum_v);
+
+    fh.add_u64(parse_fun == grammar_parse_default);
+
+    auto fp = fh.h;
+
+    if (fp == 0)  fp = 1;       //- Sic!
+
+    fingerprint_memo.store(fp, std::memory_order_relaxed);
+
+    return fp;
+}
+
+
 //---------------------------------------------------------------------
 }   //- namespace vpeg
 
@@ -271,6 +549,12 @@ v_peg_grammar_set_action(grammar_t *dst, const grammar_t *src, const char *name,
     *dst = std::make_shared<grammar_data_t>(grammar);
 }
 
+void
+v_peg_grammar_set_action_pure(grammar_action_fun_t fun)
+{
+    grammar_data_t::set_action_pure(fun);
+}
+
 void
 v_peg_grammar_erase_action(grammar_t *dst, const grammar_t *src, const char *name)
 {
@@ -324,6 +608,14 @@ v_peg_grammar_set_parse_hook(grammar_t *dst, const grammar_t *src, grammar_parse
 }
 
 
+//---------------------------------------------------------------------
+uint64_t
+v_peg_grammar_get_fingerprint(const grammar_t *grm)
+{
+    return (*grm)->fingerprint();
+}
+
+
 //---------------------------------------------------------------------
 VOIDC_DLLEXPORT_END
 
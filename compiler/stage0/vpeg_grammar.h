@@ -9,6 +9,8 @@
 #include "vpeg_parser.h"
 
 #include <utility>
+#include <atomic>
+#include <cstdint>
 
 #include <immer/map.hpp>
 
@@ -49,7 +51,8 @@ public:
         _actions(gr.actions),
         _values(gr.values),
         parse_fun(gr.parse_fun),
-        parse_aux(gr.parse_aux)
+        parse_aux(gr.parse_aux),
+        fingerprint_memo(gr.fingerprint_memo.load(std::memory_order_relaxed))
     {}
 
     grammar_data_t &operator=(const grammar_data_t &gr)
@@ -60,6 +63,8 @@ public:
         parse_fun = gr.parse_fun;
         parse_aux = gr.parse_aux;
 
+        fingerprint_memo.store(gr.fingerprint_memo.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
         return *this;
     }
 
@@ -143,6 +148,21 @@ public:
         return ret;
     }
 
+public:
+    //- Pure actions just build their results, no side effects. Units parsed
+    //- with pure actions only can be taken from the parse cache (see
+    //- voidc_parse_cache.h) - the others are parsed every time...
+
+    static void set_action_pure(grammar_action_fun_t fun);
+    static bool is_action_pure(grammar_action_fun_t fun);
+
+public:
+    //- Stable (across runs) hash of the grammar contents: parsers, names
+    //- of actions, values and the parse hook kind. Never 0. Memoized...
+    //- Not implementations: see grammar_env_t (voidc_parse_cache.h) for those.
+
+    uint64_t fingerprint(void) const;
+
 public:
     const parsers_map_t &parsers = _parsers;
     const actions_map_t &actions = _actions;
@@ -157,6 +177,9 @@ private:
     grammar_parse_t parse_fun;
     void           *parse_aux;
 
+private:
+    mutable std::atomic<uint64_t> fingerprint_memo{0};     //- 0 - not computed yet
+
 private:
     explicit grammar_data_t(const parsers_map_t &p, const actions_map_t &a, const values_map_t &v,
                             grammar_parse_t fun, void *aux)
@@ -357,6 +357,8 @@ std::any call_action_data_t::act(context_t &ctx) const
 
 #endif
 
+    if (!grammar_data_t::is_action_pure(fun))  ctx->impure_actions += 1;
+
     fun(&ret, aux, a.get(), N);
 
     return ret;
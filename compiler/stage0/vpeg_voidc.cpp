@@ -19,6 +19,8 @@ extern "C"
 static const ast_stmt_list_t stmt_list_nil = std::make_shared<const ast_stmt_list_data_t>();
 static const ast_expr_list_t expr_list_nil = std::make_shared<const ast_expr_list_data_t>();
 
+static const ast_list_builder_t list_builder_nil;
+
 static void
 mk_unit(std::any *ret, void *, const std::any *args, size_t)
 {
@@ -50,6 +52,15 @@ mk_stmt_list(std::any *ret, void *, const std::any *args, size_t)
     else        *ret = *plst;
 }
 
+static void
+mk_stmt_list_freeze(std::any *ret, void *, const std::any *args, size_t)
+{
+    auto pb = std::any_cast<ast_list_builder_t>(args+0);
+
+    if (pb) *ret = pb->freeze<ast_stmt_list_data_t>();
+    else    *ret = stmt_list_nil;
+}
+
 static void
 mk_stmt(std::any *ret, void *, const std::any *args, size_t)
 {
@@ -93,6 +104,31 @@ mk_expr_list(std::any *ret, void *, const std::any *args, size_t)
     else        *ret = *plst;
 }
 
+static void
+mk_expr_list_freeze(std::any *ret, void *, const std::any *args, size_t)
+{
+    auto pb = std::any_cast<ast_list_builder_t>(args+0);
+
+    if (pb) *ret = pb->freeze<ast_expr_list_data_t>();
+    else    *ret = expr_list_nil;
+}
+
+//---------------------------------------------------------------------
+//- Transient builder for left-recursive lists (see ast_list_builder_t)
+//---------------------------------------------------------------------
+static void
+mk_list_builder(std::any *ret, void *, const std::any *args, size_t)
+{
+    auto pb = std::any_cast<ast_list_builder_t>(args+0);
+
+    if (!pb)  pb = &list_builder_nil;
+
+    auto item = v_ast_std_any_get_base(args+1);
+
+    if (item)   *ret = pb->append(item, 1);
+    else        *ret = *pb;
+}
+
 static void
 mk_expr_identifier(std::any *ret, void *, const std::any *args, size_t)
 {
@@ -266,13 +302,18 @@ vpeg::grammar_data_t create_level_0_voidc_grammar(void)
 
     grammar_data_t gr;
 
-#define DEF(name) gr = gr.set_action(#name, name);
+#define DEF(name) \
+    gr = gr.set_action(#name, name); \
+    grammar_data_t::set_action_pure(name);
 
     DEF(mk_unit)
     DEF(mk_stmt_list)
+    DEF(mk_stmt_list_freeze)
     DEF(mk_stmt)
     DEF(mk_expr_call)
     DEF(mk_expr_list)
+    DEF(mk_expr_list_freeze)
+    DEF(mk_list_builder)
     DEF(mk_expr_identifier)
     DEF(mk_expr_integer)
     DEF(mk_expr_string)
@@ -293,10 +334,12 @@ vpeg::grammar_data_t create_level_0_voidc_grammar(void)
 
     DEF(stmt_list)
     DEF(stmt_list_lr)
+    DEF(stmt_list_tr)
     DEF(stmt)
     DEF(expr)
     DEF(expr_list)
     DEF(expr_list_lr)
+    DEF(expr_list_tr)
     DEF(prim)
 
     DEF(identifier)
@@ -374,22 +417,38 @@ vpeg::grammar_data_t create_level_0_voidc_grammar(void)
     }));
 
     //-------------------------------------------------------------
-    //- stmt_list_lr <- l:stmt_list_lr _ s:stmt     { mk_stmt_list(l, s) }
-    //-               / s:stmt                      { mk_stmt_list(0, s) }
+    //- stmt_list_lr <- b:stmt_list_tr             { mk_stmt_list_freeze(b) }
 
     gr = gr.set_parser("stmt_list_lr",
+    mk_sequence_parser(
+    {
+        mk_catch_variable_parser("b", ip_stmt_list_tr),
+
+        mk_action_parser(
+            mk_call_action("mk_stmt_list_freeze",
+            {
+                mk_identifier_argument("b")
+            })
+        )
+    }));
+
+    //-------------------------------------------------------------
+    //- stmt_list_tr <- b:stmt_list_tr _ s:stmt     { mk_list_builder(b, s) }
+    //-               / s:stmt                      { mk_list_builder(0, s) }
+
+    gr = gr.set_parser("stmt_list_tr",
     mk_choice_parser(
     {
         mk_sequence_parser(
         {
-            mk_catch_variable_parser("l", ip_stmt_list_lr),
+            mk_catch_variable_parser("b", ip_stmt_list_tr),
             ip__,
             mk_catch_variable_parser("s", ip_stmt),
 
             mk_action_parser(
-                mk_call_action("mk_stmt_list",
+                mk_call_action("mk_list_builder",
                 {
-                    mk_identifier_argument("l"),
+                    mk_identifier_argument("b"),
                     mk_identifier_argument("s")
                 })
             )
@@ -399,7 +458,7 @@ vpeg::grammar_data_t create_level_0_voidc_grammar(void)
             mk_catch_variable_parser("s", ip_stmt),
 
             mk_action_parser(
-                mk_call_action("mk_stmt_list",
+                mk_call_action("mk_list_builder",
                 {
                     mk_integer_argument(0),
                     mk_identifier_argument("s")
@@ -509,24 +568,40 @@ vpeg::grammar_data_t create_level_0_voidc_grammar(void)
     }));
 
     //-------------------------------------------------------------
-    //- expr_list_lr <- l:expr_list_lr _ ',' _ e:expr  { mk_expr_list(l, e) }
-    //-               / e:expr                         { mk_expr_list(0, e) }
+    //- expr_list_lr <- b:expr_list_tr                 { mk_expr_list_freeze(b) }
 
     gr = gr.set_parser("expr_list_lr",
+    mk_sequence_parser(
+    {
+        mk_catch_variable_parser("b", ip_expr_list_tr),
+
+        mk_action_parser(
+            mk_call_action("mk_expr_list_freeze",
+            {
+                mk_identifier_argument("b")
+            })
+        )
+    }));
+
+    //-------------------------------------------------------------
+    //- expr_list_tr <- b:expr_list_tr _ ',' _ e:expr  { mk_list_builder(b, e) }
+    //-               / e:expr                         { mk_list_builder(0, e) }
+
+    gr = gr.set_parser("expr_list_tr",
     mk_choice_parser(
     {
         mk_sequence_parser(
         {
-            mk_catch_variable_parser("l", ip_expr_list_lr),
+            mk_catch_variable_parser("b", ip_expr_list_tr),
             ip__,
             mk_character_parser(','),
             ip__,
             mk_catch_variable_parser("e", ip_expr),
 
             mk_action_parser(
-                mk_call_action("mk_expr_list",
+                mk_call_action("mk_list_builder",
                 {
-                    mk_identifier_argument("l"),
+                    mk_identifier_argument("b"),
                     mk_identifier_argument("e")
                 })
             )
@@ -536,7 +611,7 @@ vpeg::grammar_data_t create_level_0_voidc_grammar(void)
             mk_catch_variable_parser("e", ip_expr),
 
             mk_action_parser(
-                mk_call_action("mk_expr_list",
+                mk_call_action("mk_list_builder",
                 {
                     mk_integer_argument(0),
                     mk_identifier_argument("e")